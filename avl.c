@@ -22,6 +22,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "smatch.h"
 #include "smatch_slist.h"
@@ -473,6 +474,45 @@ void avl_iter_begin(AvlIter *iter, struct stree *avl, AvlDirection dir)
 	iter->node  = node;
 }
 
+/*
+ * Position a forward iterator on the first sm which belongs to "owner" and
+ * has a name which sorts at or after "name".  Since the stree is ordered by
+ * owner and then by name, all the sm states which start with a given prefix
+ * are next to each other.
+ */
+void avl_iter_begin_name(AvlIter *iter, struct stree *avl, int owner, const char *name)
+{
+	AvlNode *node;
+	const struct sm_state *sm;
+
+	iter->stack_index = 0;
+	iter->direction   = FORWARD;
+	iter->sm          = NULL;
+	iter->node        = NULL;
+
+	if (!avl)
+		return;
+
+	node = avl->root;
+	while (node) {
+		sm = node->sm;
+		if (sm->owner > owner ||
+		    (sm->owner == owner && strcmp(sm->name, name) >= 0)) {
+			iter->stack[iter->stack_index++] = node;
+			node = node->lr[0];
+		} else {
+			node = node->lr[1];
+		}
+	}
+
+	if (iter->stack_index == 0)
+		return;
+
+	node = iter->stack[--iter->stack_index];
+	iter->node = node;
+	iter->sm   = (struct sm_state *) node->sm;
+}
+
 void avl_iter_next(AvlIter *iter)
 {
 	AvlNode     *node = iter->node;
@@ -126,6 +126,7 @@ struct AvlIter {
 };
 
 void avl_iter_begin(AvlIter *iter, struct stree *avl, AvlDirection dir);
+void avl_iter_begin_name(AvlIter *iter, struct stree *avl, int owner, const char *name);
 void avl_iter_next(AvlIter *iter);
 #define avl_traverse(iter, avl, direction)        \
 	for (avl_iter_begin(&(iter), avl, direction); \
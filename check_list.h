@@ -3,6 +3,16 @@
 #define __undo_CK_def
 #endif
 
+/*
+ * CK_REQ() is for checks which can only do something for one project or when
+ * an option like --info or --spammy is set.  If the requirements aren't met
+ * then main() doesn't call the register function at all.
+ */
+#ifndef CK_REQ
+#define CK_REQ(_x, _req) CK(_x)
+#define __undo_CK_REQ_def
+#endif
+
 CK(register_db_call_marker) /* always has to be first  */
 CK(register_mtag_data)      /* before smatch_extra to clear cache at start of function */
 CK(register_param_used)     /* get_state_hooks have to be registered before smatch_extra */
@@ -55,7 +65,7 @@ CK(register_type_val)
 CK(register_data_source)
 CK(register_common_functions)
 CK(register_function_info)
-CK(register_type_links)
+CK_REQ(register_type_links, REQ_INFO)
 CK(register_impossible)
 CK(register_impossible_return)
 CK(register_strings)
@@ -66,8 +76,8 @@ CK(register_imaginary_absolute)
 CK(register_bits)
 CK(register_power_of_two)
 CK(register_simple_no_overflow)
-CK(register_fn_arg_link)
-CK(register_parameter_names)
+CK_REQ(register_fn_arg_link, REQ_INFO)
+CK_REQ(register_parameter_names, REQ_INFO)
 CK(register_return_to_param)
 CK(register_return_to_param_links)
 CK(register_constraints)
@@ -99,20 +109,20 @@ CK(register_points_to_user_data)
 
 CK(register_kernel_host_data)
 CK(register_points_to_host_data)
-CK(register_kernel_netdev_priv)
+CK_REQ(register_kernel_netdev_priv, REQ_KERNEL)
 CK(register_kernel_err_ptr)
-CK(register_kernel_has_devm_cleanup)
-CK(register_kernel_irq_context)
+CK_REQ(register_kernel_has_devm_cleanup, REQ_KERNEL)
+CK_REQ(register_kernel_irq_context, REQ_KERNEL)
 CK(register_kernel_task_state)
 CK(register_kernel_task_state_info)
-CK(register_kernel_kref_put)
-CK(register_kernel_xa_err)
+CK_REQ(register_kernel_kref_put, REQ_KERNEL)
+CK_REQ(register_kernel_xa_err, REQ_KERNEL)
 CK(register_locking)
 CK(register_locking_info)
 CK(register_locking_type)
 CK(register_free_return_states)
 CK(register_free)
-CK(register_kernel_rcu_assign_pointer)
+CK_REQ(register_kernel_rcu_assign_pointer, REQ_KERNEL)
 
 CK(check_debug)
 
@@ -131,70 +141,70 @@ CK(check_snprintf_overflow)
 CK(check_allocating_enough_data)
 CK(check_leaks)
 CK(check_type)
-CK(check_allocation_funcs)
-CK(check_frees_argument)
+CK_REQ(check_allocation_funcs, REQ_KERNEL | REQ_INFO)
+CK_REQ(check_frees_argument, REQ_INFO)
 CK(check_deref_check)
 CK(check_signed)
 CK(check_unsigned_lt_zero)
 CK(check_precedence)
-CK(check_unused_ret)
-CK(check_dma_on_stack)
-CK(check_param_mapper)
-CK(check_call_tree)
-CK(check_dev_queue_xmit)
-CK(check_stack)
-CK(check_no_return)
-CK(check_mod_timer)
+CK_REQ(check_unused_ret, REQ_TWO_PASSES)
+CK_REQ(check_dma_on_stack, REQ_KERNEL)
+CK_REQ(check_param_mapper, REQ_INFO)
+CK_REQ(check_call_tree, REQ_CALL_TREE)
+CK_REQ(check_dev_queue_xmit, REQ_KERNEL)
+CK_REQ(check_stack, REQ_KERNEL | REQ_SPAMMY)
+CK_REQ(check_no_return, REQ_INFO)
+CK_REQ(check_mod_timer, REQ_KERNEL)
 CK(check_return)
-CK(check_resource_size)
-CK(check_release_resource)
-CK(check_proc_create)
-CK(check_freeing_null)
+CK_REQ(check_resource_size, REQ_KERNEL)
+CK_REQ(check_release_resource, REQ_KERNEL)
+CK_REQ(check_proc_create, REQ_KERNEL)
+CK_REQ(check_freeing_null, REQ_SPAMMY)
 CK(check_free)
 CK(check_no_effect)
-CK(check_kunmap)
-CK(check_snprintf)
+CK_REQ(check_kunmap, REQ_KERNEL)
+CK_REQ(check_snprintf, REQ_KERNEL | REQ_SPAMMY)
 CK(check_macros)
-CK(check_return_efault)
-CK(check_gfp_dma)
+CK_REQ(check_return_efault, REQ_KERNEL)
+CK_REQ(check_gfp_dma, REQ_KERNEL)
 CK(check_unwind)
 CK(check_unwind_info)
-CK(check_kmalloc_to_bugon)
-CK(check_platform_device_put)
-CK(check_info_leak)
-CK(check_return_enomem)
-CK(check_get_user_overflow)
+CK_REQ(check_kmalloc_to_bugon, REQ_KERNEL | REQ_SPAMMY)
+CK_REQ(check_platform_device_put, REQ_KERNEL)
+CK_REQ(check_info_leak, REQ_KERNEL)
+CK_REQ(check_return_enomem, REQ_KERNEL)
+CK_REQ(check_get_user_overflow, REQ_KERNEL)
 CK(check_get_user_overflow2)
-CK(check_access_ok_math)
-CK(check_container_of)
-CK(check_input_free_device)
+CK_REQ(check_access_ok_math, REQ_KERNEL | REQ_SPAMMY)
+CK_REQ(check_container_of, REQ_KERNEL)
+CK_REQ(check_input_free_device, REQ_KERNEL)
 CK(check_select)
 CK(check_memset)
 CK(check_logical_instead_of_bitwise)
 CK(check_kmalloc_wrong_size)
 CK(check_pointer_math)
 CK(check_bit_shift)
-CK(check_macro_side_effects)
+CK_REQ(check_macro_side_effects, REQ_SPAMMY)
 CK(check_sizeof)
-CK(check_not_passing_gfp)
+CK_REQ(check_not_passing_gfp, REQ_KERNEL)
 CK(check_return_cast)
 CK(check_or_vs_and)
-CK(check_passes_sizeof)
+CK_REQ(check_passes_sizeof, REQ_INFO)
 CK(check_assign_vs_compare)
 CK(check_array_condition)
 CK(check_struct_type)
-CK(check_64bit_shift)
+CK_REQ(check_64bit_shift, REQ_SPAMMY)
 CK(check_wrong_size_arg)
 CK(check_cast_assign)
-CK(check_double_checking)
+CK_REQ(check_double_checking, REQ_SPAMMY)
 CK(check_shift_to_zero)
 CK(check_indenting)
 CK(check_unreachable)
-CK(check_missing_error_code)
+CK_REQ(check_missing_error_code, REQ_KERNEL)
 CK(check_missing_error_code2)
 CK(check_no_if_block)
 CK(check_buffer_too_small_for_struct)
-CK(check_uninitialized)
+CK_REQ(check_uninitialized, REQ_SPAMMY)
 CK(check_signed_integer_overflow_check)
 CK(check_continue_vs_break)
 CK(check_impossible_mask)
@@ -204,42 +214,42 @@ CK(check_select_type)
 CK(check_preempt)
 CK(check_preempt_info)
 CK(check_sleep_info)
-CK(check_scheduling_in_atomic)
-CK(check_checking_for_null_instead_of_err_ptr)
-CK(check_no_null_check_on_mixed)
+CK_REQ(check_scheduling_in_atomic, REQ_KERNEL)
+CK_REQ(check_checking_for_null_instead_of_err_ptr, REQ_KERNEL)
+CK_REQ(check_no_null_check_on_mixed, REQ_KERNEL)
 CK(check_syscall_arg_type)
 CK(register_param_bits_set)
 CK(register_param_bits_clear)
 CK(check_do_while_loop_limit)
-CK(check_ida_alloc)
+CK_REQ(check_ida_alloc, REQ_KERNEL)
 CK(check_mixing_irq_and_irqsave)
-CK(check_units)
+CK_REQ(check_units, REQ_SPAMMY)
 CK(check_impossible_compare)
 CK(check_always_true)
-CK(check_no_increment)
+CK_REQ(check_no_increment, REQ_SPAMMY)
 
 /* <- your test goes here */
 /* CK(register_template) */
 
 /* kernel specific */
-CK(check_kernel_printf)
+CK_REQ(check_kernel_printf, REQ_KERNEL)
 CK(check_inconsistent_locking)
-CK(check_puts_argument)
-CK(check_err_ptr)
-CK(check_err_ptr_deref)
-CK(check_expects_err_ptr)
-CK(check_return_negative_var)
-CK(check_rosenberg)
-CK(check_rosenberg2)
-CK(check_rosenberg3)
-CK(check_wait_for_common)
-CK(check_bogus_irqrestore)
-CK(check_zero_to_err_ptr)
-CK(check_freeing_devm)
+CK_REQ(check_puts_argument, REQ_KERNEL | REQ_INFO)
+CK_REQ(check_err_ptr, REQ_KERNEL | REQ_INFO)
+CK_REQ(check_err_ptr_deref, REQ_KERNEL)
+CK_REQ(check_expects_err_ptr, REQ_KERNEL | REQ_INFO)
+CK_REQ(check_return_negative_var, REQ_KERNEL)
+CK_REQ(check_rosenberg, REQ_KERNEL)
+CK_REQ(check_rosenberg2, REQ_KERNEL)
+CK_REQ(check_rosenberg3, REQ_KERNEL)
+CK_REQ(check_wait_for_common, REQ_KERNEL)
+CK_REQ(check_bogus_irqrestore, REQ_KERNEL)
+CK_REQ(check_zero_to_err_ptr, REQ_KERNEL)
+CK_REQ(check_freeing_devm, REQ_KERNEL)
 CK(check_off_by_one_relative)
-CK(check_capable)
-CK(check_ns_capable)
-CK(check_test_bit)
+CK_REQ(check_capable, REQ_KERNEL)
+CK_REQ(check_ns_capable, REQ_KERNEL)
+CK_REQ(check_test_bit, REQ_KERNEL)
 CK(check_nospec)
 CK(check_nospec_barrier)
 CK(check_spectre)
@@ -247,32 +257,32 @@ CK(check_spectre_second_half)
 CK(check_implicit_dependencies)
 CK(check_bogus_address_param)
 CK(check_pm_runtime_get_sync)
-CK(check_iterator_outside_loop)
-CK(check_list_add)
+CK_REQ(check_iterator_outside_loop, REQ_KERNEL)
+CK_REQ(check_list_add, REQ_KERNEL)
 CK(check_list_add_late)
-CK(check_sscanf_return)
+CK_REQ(check_sscanf_return, REQ_KERNEL)
 CK(check_kvmalloc_array_zero)
 CK(check_returns_negative_error_code)
 CK(check_platform_get_irq_return)
-CK(check_kvmalloc_NOFS)
-CK(check_uaf_netdev_priv)
+CK_REQ(check_kvmalloc_NOFS, REQ_KERNEL)
+CK_REQ(check_uaf_netdev_priv, REQ_KERNEL)
 //CK(check_host_input)
-CK(check_direct_return_instead_of_goto)
-CK(check_double_fget)
-CK(check_negative_error_code_type_promoted)
-CK(check_uninitialized_kobj)
-CK(check_sentinel_ctltable)
-CK(check_integer_overflow_sizeof)
+CK_REQ(check_direct_return_instead_of_goto, REQ_KERNEL)
+CK_REQ(check_double_fget, REQ_KERNEL)
+CK_REQ(check_negative_error_code_type_promoted, REQ_KERNEL)
+CK_REQ(check_uninitialized_kobj, REQ_KERNEL)
+CK_REQ(check_sentinel_ctltable, REQ_KERNEL | REQ_SPAMMY)
+CK_REQ(check_integer_overflow_sizeof, REQ_KERNEL)
 
 /* wine specific stuff */
 CK(check_wine_filehandles)
-CK(check_wine_WtoA)
+CK_REQ(check_wine_WtoA, REQ_WINE)
 
 CK(check_arm64_tagged)
 
 /* illumos specific */
-CK(check_all_func_returns)
-CK(check_cmn_err)
+CK_REQ(check_all_func_returns, REQ_ILLUMOS)
+CK_REQ(check_cmn_err, REQ_ILLUMOS_KERNEL)
 
 #include "check_list_local.h"
 
@@ -290,10 +300,15 @@ CK(register_param_key) /* has to come after smatch_extra */
 CK(register_comparison_late) /* has to come after modification_hooks_late */
 CK(register_function_hooks)
 CK(register_definition_db_callbacks_late) /* has to come after register_function_hooks() */
-CK(check_kernel)  /* this is overwriting stuff from smatch_extra_late */
-CK(check_wine)
+CK_REQ(check_kernel, REQ_KERNEL)  /* this is overwriting stuff from smatch_extra_late */
+CK_REQ(check_wine, REQ_WINE)
 CK(register_returns)
 
+#ifdef __undo_CK_REQ_def
+#undef CK_REQ
+#undef __undo_CK_REQ_def
+#endif
+
 #ifdef __undo_CK_def
 #undef CK
 #undef __undo_CK_def
@@ -93,7 +93,7 @@ static void match_assign_call(struct expression *expr)
 	struct expression *left;
 	struct assignment *assign;
 
-	if (final_pass)
+	if (final_pass && !__skipped_first_pass)
 		return;
 	if (__in_fake_parameter_assign || __in_fake_assign ||
 	    __in_fake_struct_assign)
@@ -206,6 +206,7 @@ void check_unused_ret(int id)
 	/* It turns out that this test is worthless unless you use --two-passes.  */
 	if (!option_two_passes)
 		return;
+	set_dynamic_states(my_id);
 	add_function_data((unsigned long *)&assignment_list);
 	add_hook(&match_assign_call, CALL_ASSIGNMENT_HOOK);
 	add_hook(&match_assign, ASSIGNMENT_HOOK);
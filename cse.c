@@ -35,7 +35,7 @@ static int phi_compare(pseudo_t phi1, pseudo_t phi2)
 }
 
 
-void cse_collect(struct instruction *insn)
+static int insn_hash(struct instruction *insn, unsigned long *hashp)
 {
 	unsigned long hash;
 
@@ -97,7 +97,7 @@ void cse_collect(struct instruction *insn)
 	case OP_PTRCAST:
 	case OP_UTPTR: case OP_PTRTU:
 		if (!insn->orig_type || insn->orig_type->bit_size < 0)
-			return;
+			return 0;
 		hash += hashval(insn->src);
 
 		// Note: see corresponding line in insn_compare()
@@ -123,8 +123,20 @@ void cse_collect(struct instruction *insn)
 		 * Nothing to do, don't even bother hashing them,
 		 * we're not going to try to CSE them
 		 */
-		return;
+		return 0;
 	}
+	*hashp = hash;
+	return 1;
+}
+
+void cse_collect(struct instruction *insn)
+{
+	unsigned long hash;
+
+	if (fgvn)
+		return;		// done by the walk in cse_eliminate()
+	if (!insn_hash(insn, &hash))
+		return;
 	hash += hash >> 16;
 	hash &= INSN_HASH_SIZE-1;
 	add_instruction(insn_hash_table + hash, insn);
@@ -249,7 +261,7 @@ static int insn_compare(const void *_i1, const void *_i2)
 		// Note: if it can be guaranted that identical ->src
 		// implies identical orig_type->bit_size, then this
 		// test and the hashing of the original size in
-		// cse_collect() are not needed.
+		// insn_hash() are not needed.
 		// It must be generaly true but it isn't guaranted (yet).
 		size1 = i1->orig_type->bit_size;
 		size2 = i2->orig_type->bit_size;
@@ -343,10 +355,195 @@ static struct instruction * try_to_cse(struct entrypoint *ep, struct instruction
 	return i1;
 }
 
+////////////////////////////////////////////////////////////////////////
+// Hash-based value numbering.
+//
+// Instead of collecting all the instructions, sorting the hash chains
+// and trying to CSE neighbours, the dominator tree is walked once and
+// each instruction is looked up in a table of the ones available at
+// this point: those of the dominating blocks and the ones before it
+// in its own block.  So, an equal one always dominates it and no
+// dominance check is needed.  The table is scoped: the entries of a
+// block are dropped, in LIFO order, once its subtree has been walked.
+//
+// Like try_to_cse() does, equal instructions in sibling blocks that
+// have their common idom as only parent are hoisted into it.
+
+struct gvn_entry {
+	struct instruction *insn;
+	unsigned long hash;
+	int next;
+};
+
+static struct gvn_entry *gvn_entries;
+static unsigned int gvn_nr, gvn_max;
+static int *gvn_buckets;
+static unsigned int gvn_mask;
+
+static void gvn_rehash(unsigned int size)
+{
+	unsigned int i;
+
+	free(gvn_buckets);
+	gvn_buckets = malloc(size * sizeof(*gvn_buckets));
+	if (!gvn_buckets)
+		die("out of memory");
+	gvn_mask = size - 1;
+	for (i = 0; i < size; i++)
+		gvn_buckets[i] = -1;
+	for (i = 0; i < gvn_nr; i++) {
+		struct gvn_entry *e = &gvn_entries[i];
+		int *head = &gvn_buckets[e->hash & gvn_mask];
+
+		e->next = *head;
+		*head = i;
+	}
+}
+
+static void gvn_push(struct instruction *insn, unsigned long hash)
+{
+	struct gvn_entry *e;
+	int *head;
+
+	if (gvn_nr == gvn_max) {
+		gvn_max = gvn_max ? gvn_max * 2 : 256;
+		gvn_entries = realloc(gvn_entries, gvn_max * sizeof(*gvn_entries));
+		if (!gvn_entries)
+			die("out of memory");
+	}
+	if (gvn_nr >= gvn_mask)
+		gvn_rehash(gvn_mask ? 2 * (gvn_mask + 1) : 256);
+
+	head = &gvn_buckets[hash & gvn_mask];
+	e = &gvn_entries[gvn_nr];
+	e->insn = insn;
+	e->hash = hash;
+	e->next = *head;
+	*head = gvn_nr++;
+}
+
+static void gvn_pop(unsigned int mark)
+{
+	while (gvn_nr > mark) {
+		struct gvn_entry *e = &gvn_entries[--gvn_nr];
+		gvn_buckets[e->hash & gvn_mask] = e->next;
+	}
+}
+
+static struct instruction *gvn_lookup(struct instruction *insn, unsigned long hash)
+{
+	int i;
+
+	if (!gvn_nr)
+		return NULL;
+	for (i = gvn_buckets[hash & gvn_mask]; i >= 0; i = gvn_entries[i].next) {
+		struct gvn_entry *e = &gvn_entries[i];
+
+		if (e->hash != hash || !e->insn->bb)
+			continue;
+		if (!insn_compare(e->insn, insn))
+			return e->insn;
+	}
+	return NULL;
+}
+
+static unsigned long gvn_hash(struct instruction *insn)
+{
+	unsigned long hash;
+
+	if (!insn_hash(insn, &hash))
+		return 0;
+	hash *= 0x9e3779b97f4a7c15ULL;
+	return (hash ^ (hash >> 29)) | 1;
+}
+
+static struct basic_block *only_parent(struct basic_block *bb)
+{
+	if (bb_list_size(bb->parents) != 1)
+		return NULL;
+	return first_basic_block(bb->parents);
+}
+
+static void gvn_hoist(struct basic_block *bb)
+{
+	struct instruction_list *hoisted = NULL;
+	struct basic_block *child;
+	struct instruction *insn;
+	unsigned int mark = gvn_nr;
+	int nr = 0;
+
+	FOR_EACH_PTR(bb->doms, child) {
+		if (only_parent(child) == bb)
+			nr++;
+	} END_FOR_EACH_PTR(child);
+	if (nr < 2)
+		return;
+
+	FOR_EACH_PTR(bb->doms, child) {
+		if (only_parent(child) != bb)
+			continue;
+		FOR_EACH_PTR(child->insns, insn) {
+			struct instruction *def;
+			unsigned long hash;
+
+			if (insn->bb != child || !(hash = gvn_hash(insn)))
+				continue;
+			def = gvn_lookup(insn, hash);
+			if (!def) {
+				gvn_push(insn, hash);
+				continue;
+			}
+			if (def->bb == bb || def->bb == child || only_parent(def->bb) != bb)
+				continue;	// the walk will take care of it
+			def = try_to_cse(bb->ep, def, insn);
+			if (def->bb == bb)
+				add_instruction(&hoisted, def);
+		} END_FOR_EACH_PTR(insn);
+	} END_FOR_EACH_PTR(child);
+	gvn_pop(mark);
+
+	FOR_EACH_PTR(hoisted, insn) {
+		gvn_push(insn, gvn_hash(insn));
+	} END_FOR_EACH_PTR(insn);
+	free_ptr_list(&hoisted);
+}
+
+static void gvn_walk(struct basic_block *bb)
+{
+	unsigned int mark = gvn_nr;
+	struct basic_block *child;
+	struct instruction *insn;
+
+	FOR_EACH_PTR(bb->insns, insn) {
+		struct instruction *def;
+		unsigned long hash;
+
+		if (insn->bb != bb || !(hash = gvn_hash(insn)))
+			continue;
+		def = gvn_lookup(insn, hash);
+		if (def)
+			cse_one_instruction(insn, def);
+		else
+			gvn_push(insn, hash);
+	} END_FOR_EACH_PTR(insn);
+
+	gvn_hoist(bb);
+
+	FOR_EACH_PTR(bb->doms, child) {
+		gvn_walk(child);
+	} END_FOR_EACH_PTR(child);
+	gvn_pop(mark);
+}
+
 void cse_eliminate(struct entrypoint *ep)
 {
 	int i;
 
+	if (fgvn) {
+		gvn_walk(ep->entry->bb);
+		return;
+	}
+
 	for (i = 0; i < INSN_HASH_SIZE; i++) {
 		struct instruction_list **list = insn_hash_table + i;
 		if (*list) {
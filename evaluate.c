@@ -1996,36 +1996,18 @@ static struct symbol *evaluate_preop(struct expression *expr)
 
 struct symbol *find_identifier(struct ident *ident, struct symbol_list *_list, int *offset)
 {
-	struct ptr_list *head = (struct ptr_list *)_list;
-	struct ptr_list *list = head;
+	struct symbol *sym, *sub;
 
-	if (!head)
+	sym = get_struct_member(_list, ident);
+	if (!sym)
 		return NULL;
-	do {
-		int i;
-		for (i = 0; i < list->nr; i++) {
-			struct symbol *sym = (struct symbol *) list->list[i];
-			if (sym->ident) {
-				if (sym->ident != ident)
-					continue;
-				*offset = sym->offset;
-				return sym;
-			} else {
-				struct symbol *ctype = sym->ctype.base_type;
-				struct symbol *sub;
-				if (!ctype)
-					continue;
-				if (ctype->type != SYM_UNION && ctype->type != SYM_STRUCT)
-					continue;
-				sub = find_identifier(ident, ctype->symbol_list, offset);
-				if (!sub)
-					continue;
-				*offset += sym->offset;
-				return sub;
-			}	
-		}
-	} while ((list = list->next) != head);
-	return NULL;
+	if (sym->ident) {
+		*offset = sym->offset;
+		return sym;
+	}
+	sub = find_identifier(ident, sym->ctype.base_type->symbol_list, offset);
+	*offset += sym->offset;
+	return sub;
 }
 
 static struct expression *evaluate_offset(struct expression *expr, unsigned long offset)
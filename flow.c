@@ -403,10 +403,14 @@ void convert_instruction_target(struct instruction *insn, pseudo_t src)
 		if (*pu->userp != VOID) {
 			assert(*pu->userp == target);
 			*pu->userp = src;
+			queue_insn(pu->insn);
 		}
 	} END_FOR_EACH_PTR(pu);
-	if (has_use_list(src))
+	if (has_use_list(src)) {
 		concat_user_list(target->users, &src->users);
+		if (has_definition(src))
+			queue_insn(src->def);
+	}
 	target->users = NULL;
 }
 
@@ -72,12 +72,18 @@ static int check_user(struct instruction *insn, pseudo_t pseudo)
 	case PSEUDO_PHI:
 	case PSEUDO_REG:
 		def = pseudo->def;
-		if (def && def->bb)
-			break;
-		show_entry(insn->bb->ep);
-		sparse_error(insn->pos, "wrong usage for %s in %s", show_pseudo(pseudo),
-			show_instruction(insn));
-		return 1;
+		if (!def || !def->bb) {
+			show_entry(insn->bb->ep);
+			sparse_error(insn->pos, "wrong usage for %s in %s", show_pseudo(pseudo),
+				show_instruction(insn));
+			return 1;
+		}
+		if (!ptr_list_count_ok((struct ptr_list *)pseudo->users)) {
+			sparse_error(insn->pos, "wrong user count for %s: %d",
+				show_pseudo(pseudo), nbr_users(pseudo));
+			return 1;
+		}
+		break;
 
 	default:
 		break;
@@ -49,6 +49,7 @@
 #include "bits.h"
 
 int parse_error;
+unsigned int nr_diagnostics;
 
 static int prettify(const char **fnamep)
 {
@@ -161,6 +162,7 @@ static void do_error(struct position pos, const char * fmt, va_list args)
 {
 	static int errors = 0;
 
+	nr_diagnostics++;
 	parse_error = 1;
         die_if_error = 1;
 	show_info = 1;
@@ -186,6 +188,7 @@ void warning(struct position pos, const char * fmt, ...)
 {
 	va_list args;
 
+	nr_diagnostics++;
 	if (Wsparse_error) {
 		va_start(args, fmt);
 		do_error(pos, fmt, args);
@@ -298,12 +301,15 @@ static void create_builtin_stream(void)
 	add_pre_buffer("#define __builtin_va_arg_pack()\n");
 }
 
+struct token *preprocessed_tokens;
+
 static struct symbol_list *sparse_tokenstream(struct token *token)
 {
 	int builtin = token && !token->pos.stream;
 
 	// Preprocess the stream
 	token = preprocess(token);
+	preprocessed_tokens = token;
 
 	if (dump_macro_defs || dump_macros_only) {
 		if (!builtin)
@@ -419,7 +425,7 @@ struct symbol_list *sparse_initialize(int argc, char **argv, struct string_list
 			die("error: cannot open %s: %s", outfile, strerror(errno));
 	}
 
-	if (fdump_ir == 0)
+	if (!fdump_ir)
 		fdump_ir = PASS_FINAL;
 
 	list = NULL;
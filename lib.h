@@ -45,6 +45,7 @@
 #endif
 
 extern int parse_error;
+extern unsigned int nr_diagnostics;
 
 #ifndef PATH_MAX
 #define PATH_MAX 4096			// Hurd doesn't define this
@@ -127,6 +128,8 @@ enum phase {
 #define	PASS_OPTIM		(1UL << PASS__OPTIM)
 #define	PASS_FINAL		(1UL << PASS__FINAL)
 
+#define	DUMP_STATS		(1UL << (PASS__FINAL + 1))	// -fdump-ir=stats
+
 
 extern void add_pre_buffer(const char *fmt, ...) FORMAT_ATTR(1);
 extern void predefine(const char *name, int weak, const char *fmt, ...) FORMAT_ATTR(3);
@@ -91,6 +91,7 @@ struct instruction {
 	unsigned opcode:7,
 		 tainted:1,
 		 size:24;
+	unsigned queued:1;		// on the simplification worklist
 	struct basic_block *bb;
 	struct position pos;
 	struct symbol *type;
@@ -266,7 +267,7 @@ static inline bool has_definition(pseudo_t p)
 
 static inline int pseudo_user_list_size(struct pseudo_user_list *list)
 {
-	return ptr_list_size((struct ptr_list *)list);
+	return ptr_list_counted_size((struct ptr_list *)list);
 }
 
 static inline bool pseudo_user_list_empty(struct pseudo_user_list *list)
@@ -65,17 +65,30 @@ static void insert_macro_string(struct string_list **str_list, char *new)
 	add_ptr_list(str_list, new);
 }
 
+/*
+ * The key is a copy of the position, the preprocessor frees the macro
+ * name token once the expansion is done.
+ */
 void store_macro_pos(struct token *token)
 {
 	struct string_list *list;
+	struct position *key;
 
 	if (!macro_table)
 		macro_table = create_hashtable(5000, position_hash, equalkeys);
 
 	list = do_search_macro(macro_table, &token->pos);
+	if (list) {
+		insert_macro_string(&list, token->ident->name);
+		return;
+	}
 	insert_macro_string(&list, token->ident->name);
 
-	do_insert_macro(macro_table, &token->pos, list);
+	key = malloc(sizeof(*key));
+	if (!key)
+		return;
+	*key = token->pos;
+	do_insert_macro(macro_table, key, list);
 }
 
 char *get_macro_name(struct position pos)
@@ -48,6 +48,8 @@ complex_phi:
 	kill_use(&insn->src);
 	insn->opcode = OP_PHI;
 	insn->phi_list = dominators;
+	queue_insn(insn);
+	queue_users(insn->target);
 
 end:
 	repeat_phase |= REPEAT_CSE;
@@ -7,6 +7,7 @@
 // Optimization main loop
 // ----------------------
 
+#include <stdio.h>
 #include <assert.h>
 #include "optimize.h"
 #include "flowgraph.h"
@@ -30,16 +31,48 @@ static void clear_symbol_pseudos(struct entrypoint *ep)
 }
 
 
-static void clean_up_insns(struct entrypoint *ep)
+static unsigned int nr_iterations, nr_full_passes, nr_visits;
+
+static void clean_up_insn(struct instruction *insn)
+{
+	int changed;
+
+	nr_visits++;
+	changed = simplify_instruction(insn);
+	if (!changed)
+		return;
+	repeat_phase |= changed;
+
+	// it may be simplified further and so may be its users
+	// and the instructions it now uses
+	queue_insn(insn);
+	queue_users(insn->target);
+	queue_defs(insn);
+
+	// or the new instruction it has been replaced with
+	if (!insn->bb && insn->target && has_definition(insn->target) && insn->target->def != insn)
+		queue_insn(insn->target->def);
+}
+
+///
+// simplify the instructions of a function
+// @full: if 0, only the queued ones are visited
+static void clean_up_insns(struct entrypoint *ep, int full)
 {
 	struct basic_block *bb;
 
+	if (full)
+		nr_full_passes++;
 	FOR_EACH_PTR(ep->bbs, bb) {
 		struct instruction *insn;
+
 		FOR_EACH_PTR(bb->insns, insn) {
+			if (!full && !insn->queued)
+				continue;
+			insn->queued = 0;
 			if (!insn->bb)
 				continue;
-			repeat_phase |= simplify_instruction(insn);
+			clean_up_insn(insn);
 			if (!insn->bb)
 				continue;
 			assert(insn->bb == bb);
@@ -58,6 +91,8 @@ static void cleanup_cfg(struct entrypoint *ep)
 // optimization main loop
 void optimize(struct entrypoint *ep)
 {
+	nr_iterations = nr_full_passes = nr_visits = 0;
+
 	if (fdump_ir & PASS_LINEARIZE)
 		show_entry(ep);
 
@@ -90,22 +125,44 @@ repeat:
 	/*
 	 * Remove trivial instructions, and try to CSE
 	 * the rest.
+	 *
+	 * With -fworklist, only the instructions queued on the
+	 * worklist, because something they depend on has changed,
+	 * are simplified again, but the whole function is still
+	 * walked after a change to the CFG, for the old CSE which
+	 * needs to collect all the instructions, and to check that
+	 * nothing more can be done before leaving the loop.
 	 */
+	if (fworklist)
+		set_worklist(ep, 1);
 	do {
+		int full = 1;
+
 		simplify_memops(ep);
-		do {
+		for (;;) {
+			nr_iterations++;
 			repeat_phase = 0;
-			clean_up_insns(ep);
+			clean_up_insns(ep, full);
 			if (repeat_phase & REPEAT_CFG_CLEANUP)
 				kill_unreachable_bbs(ep);
 
 			cse_eliminate(ep);
 			simplify_memops(ep);
-		} while (repeat_phase);
+
+			if (!repeat_phase) {
+				if (full)
+					break;
+				full = 1;
+			} else {
+				full = !fworklist || !fgvn || (repeat_phase & REPEAT_CFG_CLEANUP);
+			}
+		}
 		pack_basic_blocks(ep);
 		if (repeat_phase & REPEAT_CFG_CLEANUP)
 			cleanup_cfg(ep);
 	} while (repeat_phase);
+	if (fworklist)
+		set_worklist(ep, 0);
 
 	vrfy_flow(ep);
 
@@ -131,4 +188,8 @@ repeat:
 	/* Finally, add deathnotes to pseudos now that we have them */
 	if (dbg_dead)
 		track_pseudo_death(ep);
+
+	if (fdump_ir & DUMP_STATS)
+		printf("%s: %u iterations, %u full passes, %u instructions visited\n",
+			show_ident(ep->name->ident), nr_iterations, nr_full_passes, nr_visits);
 }
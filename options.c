@@ -73,6 +73,7 @@ int dump_macros_only = 0;
 int dissect_show_all_symbols = 0;
 
 unsigned long fdump_ir;
+int fgvn = 1;
 int fhosted = 1;
 unsigned int fmax_errors = 100;
 unsigned int fmax_warnings = 100;
@@ -84,6 +85,8 @@ int fpie = 0;
 int fshort_wchar = 0;
 int funsigned_bitfields = 0;
 int funsigned_char = 0;
+const char *ftoken_cache;
+int fworklist = 0;
 
 int Waddress = 0;
 int Waddress_space = 1;
@@ -490,6 +493,7 @@ static int handle_fdump_ir(const char *arg, const char *opt, const struct flag *
 		{ "linearize",		PASS_LINEARIZE },
 		{ "mem2reg",		PASS_MEM2REG },
 		{ "final",		PASS_FINAL },
+		{ "stats",		DUMP_STATS },
 		{ },
 	};
 
@@ -514,10 +518,19 @@ static int handle_fmax_warnings(const char *arg, const char *opt, const struct f
 	return 1;
 }
 
+static int handle_ftoken_cache(const char *arg, const char *opt, const struct flag *flag, int options)
+{
+	if (*opt == '\0')
+		die("error: missing argument to \"%s\"", arg);
+	ftoken_cache = opt;
+	return 1;
+}
+
 static struct flag fflags[] = {
 	{ "diagnostic-prefix",	NULL,	handle_fdiagnostic_prefix },
 	{ "dump-ir",		NULL,	handle_fdump_ir },
 	{ "freestanding",	&fhosted, NULL, OPT_INVERSE },
+	{ "gvn",		&fgvn },
 	{ "hosted",		&fhosted },
 	{ "linearize",		NULL,	handle_fpasses,	PASS_LINEARIZE },
 	{ "max-errors=",	NULL,	handle_fmax_errors },
@@ -525,6 +538,7 @@ static struct flag fflags[] = {
 	{ "mem-report",		&fmem_report },
 	{ "memcpy-max-count=",	NULL,	handle_fmemcpy_max_count },
 	{ "tabstop=",		NULL,	handle_ftabstop },
+	{ "token-cache=",	NULL,	handle_ftoken_cache },
 	{ "mem2reg",		NULL,	handle_fpasses,	PASS_MEM2REG },
 	{ "optim",		NULL,	handle_fpasses,	PASS_OPTIM },
 	{ "pic",		&fpic,	handle_switch_setval, 1 },
@@ -536,6 +550,7 @@ static struct flag fflags[] = {
 	{ "signed-char",	&funsigned_char, NULL,	OPT_INVERSE },
 	{ "short-wchar",	&fshort_wchar },
 	{ "unsigned-char",	&funsigned_char, NULL, },
+	{ "worklist",		&fworklist },
 	{ },
 };
 
@@ -73,6 +73,7 @@ extern int dump_macros_only;
 extern int dissect_show_all_symbols;
 
 extern unsigned long fdump_ir;
+extern int fgvn;
 extern int fhosted;
 extern unsigned int fmax_errors;
 extern unsigned int fmax_warnings;
@@ -84,6 +85,8 @@ extern int fpie;
 extern int fshort_wchar;
 extern int funsigned_bitfields;
 extern int funsigned_char;
+extern const char *ftoken_cache;
+extern int fworklist;
 
 extern int Waddress;
 extern int Waddress_space;
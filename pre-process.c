@@ -33,6 +33,8 @@
 #include <ctype.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <stdint.h>
 #include <limits.h>
 #include <time.h>
 #include <dirent.h>
@@ -235,14 +237,48 @@ static int expand_one_symbol(struct token **list)
 	}
 }
 
+/*
+ * Macro expansion allocates a new token for every token of the body and
+ * for every extra use of an argument.  The tokens which drop out of the
+ * stream along the way (the macro name, the parentheses and commas of
+ * the call, unused arguments, the TOKEN_UNTAINT markers and the right
+ * hand side of a ## paste) go back on the token freelist so that the
+ * next expansion can reuse them.
+ */
+static unsigned int expansion_tokens, recycled_tokens;
+
+static void recycle_token(struct token *token)
+{
+	__free_token(token);
+	recycled_tokens++;
+}
+
+static void recycle_separator(struct token *token)
+{
+	if (token_type(token) == TOKEN_SPECIAL)
+		recycle_token(token);
+}
+
+static void recycle_list(struct token *list)
+{
+	while (!eof_token(list)) {
+		struct token *next = list->next;
+		recycle_token(list);
+		list = next;
+	}
+}
+
 static inline struct token *scan_next(struct token **where)
 {
 	struct token *token = *where;
 	if (token_type(token) != TOKEN_UNTAINT)
 		return token;
 	do {
+		struct token *next = token->next;
+
 		token->ident->tainted = 0;
-		token = token->next;
+		recycle_token(token);
+		token = next;
 	} while (token_type(token) == TOKEN_UNTAINT);
 	*where = token;
 	return token;
@@ -354,6 +390,7 @@ static int collect_arguments(struct token *start, struct token *arglist, struct
 				count++;
 				break;
 			}
+			recycle_separator(start);
 			start = next;
 		}
 		if (count == wanted && !match_op(next, ')'))
@@ -371,6 +408,8 @@ static int collect_arguments(struct token *start, struct token *arglist, struct
 			goto Efew;
 	}
 	what->next = next->next;
+	recycle_separator(start);
+	recycle_separator(next);
 	return 1;
 
 Efew:
@@ -402,6 +441,7 @@ static struct token *dup_list(struct token *list)
 
 	while (!eof_token(list)) {
 		struct token *newtok = __alloc_token(0);
+		expansion_tokens++;
 		*newtok = *list;
 		*p = newtok;
 		p = &newtok->next;
@@ -445,6 +485,7 @@ static struct token *stringify(struct token *arg)
 	struct token *token = __alloc_token(0);
 	struct string *string = __alloc_string(size);
 
+	expansion_tokens++;
 	memcpy(string->data, s, size);
 	string->length = size;
 	token->pos = arg->pos;
@@ -595,6 +636,7 @@ static int merge(struct token *left, struct token *right)
 static struct token *dup_token(struct token *token, struct position *streampos)
 {
 	struct token *alloc = alloc_token(streampos);
+	expansion_tokens++;
 	token_type(alloc) = token_type(token);
 	alloc->pos.newline = token->pos.newline;
 	alloc->pos.whitespace = token->pos.whitespace;
@@ -736,6 +778,7 @@ static struct token **substitute(struct token **list, struct token *body, struct
 			*list = added->next;
 			if (tail != &added->next)
 				list = tail;
+			recycle_token(added);
 		} else {
 			*list = added;
 			list = tail;
@@ -755,6 +798,7 @@ static int expand(struct token **list, struct symbol *sym)
 	struct token *expansion = sym->expansion;
 	int nargs = sym->arglist ? sym->arglist->count.normal : 0;
 	struct arg args[nargs];
+	int i;
 
 	if (expanding->tainted) {
 		token->pos.noexpand = 1;
@@ -774,6 +818,14 @@ static int expand(struct token **list, struct symbol *sym)
 
 	expanding->tainted = 1;
 
+	/* Arguments which are only stringified, or not used at all */
+	for (i = 0; i < nargs; i++) {
+		if (args[i].arg && !args[i].n_normal && !args[i].n_quoted) {
+			recycle_list(args[i].arg);
+			args[i].arg = NULL;
+		}
+	}
+
 	last = token->next;
 	tail = substitute(list, expansion, args);
 	/*
@@ -785,6 +837,7 @@ static int expand(struct token **list, struct symbol *sym)
 	(*list)->pos.newline = token->pos.newline;
 	(*list)->pos.whitespace = token->pos.whitespace;
 	*tail = last;
+	recycle_token(token);
 
 	return 0;
 }
@@ -900,6 +953,66 @@ static void set_stream_include_path(struct stream *stream)
 	includepath[0] = path;
 }
 
+/*
+ * With a long list of include directories, most of the open() calls in
+ * try_include() fail.  The include directories don't change while we're
+ * running so remember the names which don't exist and don't ask again.
+ */
+#define MISSING_HASH_BITS (10)
+#define MISSING_HASH_SIZE (1 << MISSING_HASH_BITS)
+
+struct missing_include {
+	struct missing_include *next;
+	char name[];
+};
+
+static struct missing_include *missing_includes[MISSING_HASH_SIZE];
+static unsigned int include_opens, include_opens_avoided;
+
+static struct missing_include **missing_include_slot(const char *name)
+{
+	uint32_t hash = 0;
+	unsigned char c;
+
+	while ((c = *name++) != 0)
+		hash = (hash + (c << 4) + (c >> 4)) * 11;
+	hash *= 0x9e370001UL;
+	return &missing_includes[hash >> (32 - MISSING_HASH_BITS)];
+}
+
+static int is_missing_include(const char *name)
+{
+	struct missing_include *m;
+
+	for (m = *missing_include_slot(name); m; m = m->next) {
+		if (strcmp(m->name, name) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+static void add_missing_include(const char *name, int len)
+{
+	struct missing_include **slot = missing_include_slot(name);
+	struct missing_include *m;
+
+	m = malloc(sizeof(*m) + len + 1);
+	if (!m)
+		return;
+	memcpy(m->name, name, len);
+	m->name[len] = '\0';
+	m->next = *slot;
+	*slot = m;
+}
+
+void show_preprocess_stats(void)
+{
+	fprintf(stderr, "include: %u open() calls, %u avoided\n",
+		include_opens, include_opens_avoided);
+	fprintf(stderr, "macro expansion: %u tokens allocated, %u recycled\n",
+		expansion_tokens, recycled_tokens);
+}
+
 static int try_include(struct position pos, const char *path, const char *filename, int flen, struct token **where, const char **next_path)
 {
 	int fd;
@@ -914,6 +1027,11 @@ static int try_include(struct position pos, const char *path, const char *filena
 	memcpy(fullname+plen, filename, flen);
 	if (already_tokenized(fullname))
 		return 1;
+	if (is_missing_include(fullname)) {
+		include_opens_avoided++;
+		return 0;
+	}
+	include_opens++;
 	fd = open(fullname, O_RDONLY);
 	if (fd >= 0) {
 		char *streamname = xmemdup(fullname, plen + flen);
@@ -921,6 +1039,8 @@ static int try_include(struct position pos, const char *path, const char *filena
 		close(fd);
 		return 1;
 	}
+	if (errno == ENOENT || errno == ENOTDIR)
+		add_missing_include(fullname, plen + flen);
 	return 0;
 }
 
@@ -32,21 +32,60 @@ __DECLARE_ALLOCATOR(struct ptr_list, ptrlist);
 __ALLOCATOR(struct ptr_list, "ptr list", ptrlist);
 __ALLOCATOR(struct ptr_list, "rl ptr list", rl_ptrlist);
 
+static int count_ptr_list(struct ptr_list *head)
+{
+	struct ptr_list *list = head;
+	int nr = 0;
+
+	do {
+		nr += list->nr - list->rm;
+	} while ((list = list->next) != head);
+	return nr;
+}
+
 ///
 // get the size of a ptrlist
 // @head: the head of the list
 // @return: the size of the list given by @head.
 int ptr_list_size(struct ptr_list *head)
 {
-	int nr = 0;
+	if (!head)
+		return 0;
+	if (head->counted)
+		return head->count;
+	return count_ptr_list(head);
+}
 
-	if (head) {
-		struct ptr_list *list = head;
-		do {
-			nr += list->nr - list->rm;
-		} while ((list = list->next) != head);
+///
+// get the size of a ptrlist and keep track of it from now on
+// @head: the head of the list
+// @return: the size of the list given by @head.
+//
+// The first call walks the list, then the count is stored in its
+// head block and maintained by the functions and macros changing
+// the list, so that this and :func:`ptr_list_size` are O(1).
+// It's meant for lists whose size is asked for often.
+int ptr_list_counted_size(struct ptr_list *head)
+{
+	if (!head)
+		return 0;
+	if (!head->counted) {
+		head->count = count_ptr_list(head);
+		head->counted = 1;
 	}
-	return nr;
+	return head->count;
+}
+
+///
+// check the count maintained for a ptrlist
+// @head: the head of the list
+// @return: ``false`` if the list is counted and its count is wrong,
+//	``true`` otherwise.
+bool ptr_list_count_ok(struct ptr_list *head)
+{
+	if (!head || !head->counted)
+		return true;
+	return head->count == count_ptr_list(head);
 }
 
 ///
@@ -59,6 +98,8 @@ bool ptr_list_empty(const struct ptr_list *head)
 
 	if (!head)
 		return true;
+	if (head->counted)
+		return head->count == 0;
 
 	do {
 		if (list->nr - list->rm)
@@ -79,6 +120,8 @@ bool ptr_list_multiple(const struct ptr_list *head)
 
 	if (!head)
 		return false;
+	if (head->counted)
+		return head->count > 1;
 
 	do {
 		nr += list->nr - list->rm;
@@ -213,13 +256,16 @@ restart:
 				prev = entry->prev;
 				prev->next = next;
 				next->prev = prev;
-				__free_ptrlist(entry);
 				if (entry == head) {
+					next->counted = head->counted;
+					next->count = head->count;
+					__free_ptrlist(entry);
 					*listp = next;
 					head = next;
 					entry = next;
 					goto restart;
 				}
+				__free_ptrlist(entry);
 			}
 			entry = next;
 		} while (entry != head);
@@ -290,6 +336,7 @@ void **__add_ptr_list(struct ptr_list **listp, void *ptr)
 	*ret = ptr;
 	nr++;
 	last->nr = nr;
+	PTR_LIST_COUNT(*listp, 1);
 	return ret;
 }
 
@@ -399,6 +446,7 @@ void * undo_ptr_list_last(struct ptr_list **head)
 			int nr = --last->nr;
 			ptr = last->list[nr];
 			last->list[nr] = (void *)0xf1f1f1f1;
+			PTR_LIST_COUNT(first, -1);
 			return ptr;
 		}
 	} while (last != first);
@@ -417,8 +465,10 @@ void * delete_ptr_list_last(struct ptr_list **head)
 	if (!first)
 		return NULL;
 	last = first->prev;
-	if (last->nr)
+	if (last->nr) {
 		ptr = last->list[--last->nr];
+		PTR_LIST_COUNT(first, -1);
+	}
 	if (last->nr <=0) {
 		first->prev = last->prev;
 		last->prev->next = first;
@@ -450,7 +500,7 @@ void copy_ptr_list(struct ptr_list **listp, struct ptr_list *src)
 {
 	struct ptr_list *head, *tail;
 	struct ptr_list *cur = src;
-	int idx;
+	int idx, copied = 0;
 
 	if (!src)
 		return;
@@ -479,6 +529,7 @@ void copy_ptr_list(struct ptr_list **listp, struct ptr_list *src)
 				idx = 0;
 			}
 			tail->list[idx++] = ptr;
+			copied++;
 		}
 
 		next = cur->next;
@@ -489,6 +540,7 @@ void copy_ptr_list(struct ptr_list **listp, struct ptr_list *src)
 	tail->nr = idx;
 	head->prev = tail;
 	tail->next = head;
+	PTR_LIST_COUNT(head, copied);
 }
 
 ///
@@ -21,6 +21,8 @@
 	struct listname {			\
 		int nr:8;			\
 		int rm:8;			\
+		unsigned int counted:1;		\
+		int count;			\
 		struct listname *prev;		\
 		struct listname *next;		\
 		type *list[LIST_NODE_NR];	\
@@ -39,6 +41,8 @@ extern void sort_list(struct ptr_list **, int (*)(const void *, const void *));
 extern void concat_ptr_list(struct ptr_list *a, struct ptr_list **b);
 extern void copy_ptr_list(struct ptr_list **h, struct ptr_list *t);
 extern int ptr_list_size(struct ptr_list *);
+extern int ptr_list_counted_size(struct ptr_list *);
+extern bool ptr_list_count_ok(struct ptr_list *);
 extern bool ptr_list_empty(const struct ptr_list *head);
 extern bool ptr_list_multiple(const struct ptr_list *head);
 extern int linearize_ptr_list(struct ptr_list *, void **, int);
@@ -143,7 +147,7 @@ extern void __free_ptr_list(struct ptr_list **);
 // It's used when an element of the list must be removed
 // but the address of the other elements must not be changed.
 #define MARK_CURRENT_DELETED(ptr) \
-	DO_MARK_CURRENT_DELETED(ptr, __list##ptr)
+	DO_MARK_CURRENT_DELETED(ptr, __head##ptr, __list##ptr)
 
 #define PACK_PTR_LIST(x) \
 	pack_ptr_list((struct ptr_list **)(x))
@@ -162,6 +166,13 @@ extern void __free_ptr_list(struct ptr_list **);
 #define PTR_ENTRY_UNTAG(h,i)	PTR_UNTAG((h)->list[i])
 
 
+// Only the head block of a list carries its element count, and
+// only once ptr_list_counted_size() has been called on it.
+#define PTR_LIST_COUNT(head, delta) do {				\
+		if ((head)->counted)					\
+			(head)->count += (delta);			\
+	} while (0)
+
 #define PTR_NEXT(ptr, __head, __list, __nr, PTR_ENTRY)			\
 	do {								\
 		if (__nr < __list->nr) {				\
@@ -279,6 +290,7 @@ extern void split_ptr_list_head(struct ptr_list *);
 	}								\
 	*__this = (new);						\
 	__list->nr++;							\
+	PTR_LIST_COUNT(__head, 1);					\
 } while (0)
 
 #define DO_DELETE_CURRENT(__head, __list, __nr) do {			\
@@ -290,12 +302,14 @@ extern void split_ptr_list_head(struct ptr_list *);
 	}								\
 	*__this = (void *)0xf0f0f0f0;					\
 	__list->nr--; __nr--;						\
+	PTR_LIST_COUNT(__head, -1);					\
 } while (0)
 
 
-#define DO_MARK_CURRENT_DELETED(ptr, __list) do {			\
+#define DO_MARK_CURRENT_DELETED(ptr, __head, __list) do {		\
 		REPLACE_CURRENT_PTR(ptr, NULL);				\
 		__list->rm++;						\
+		PTR_LIST_COUNT(__head, -1);				\
 	} while (0)
 
 
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 /*
- * Stupid implementation of pointer -> pointer map.
+ * Stupid implementation of pointer -> pointer map,
+ * turned into a hash table once it holds more than a few pairs.
  *
  * Copyright (c) 2017 Luc Van Oostenryck.
  *
@@ -25,10 +26,16 @@
 
 #include "ptrmap.h"
 #include "allocate.h"
+#include "lib.h"
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 
 #define	MAP_NR	7
 
+// Past this number of pairs, a map switches to a hash table.
+#define	MAP_HASH_MIN	(4 * MAP_NR)
+
 struct ptrpair {
 	void *key;
 	void *val;
@@ -36,12 +43,92 @@ struct ptrpair {
 struct ptrmap {
 	struct ptrmap *next;
 	int nr;
+	unsigned int count;		// in the head: total number of pairs
+	struct ptrpair *table;		// in the head: the hash table, if any
+	unsigned int mask;
 	struct ptrpair pairs[MAP_NR];
 };
 
 DECLARE_ALLOCATOR(ptrmap);
 ALLOCATOR(ptrmap, "ptrmap");
 
+////////////////////////////////////////////////////////////////////////
+// Open addressing hash table, with linear probing.
+// A NULL key marks a free slot.
+
+static inline unsigned int hash_key(void *key)
+{
+	return ((uint64_t)(uintptr_t)key * 0x9e3779b97f4a7c15ULL) >> 32;
+}
+
+static struct ptrpair *hash_slot(struct ptrpair *table, unsigned int mask, void *key)
+{
+	unsigned int i = hash_key(key) & mask;
+
+	while (table[i].key && table[i].key != key)
+		i = (i + 1) & mask;
+	return &table[i];
+}
+
+static void hash_resize(struct ptrmap *head, unsigned int size)
+{
+	struct ptrpair *old = head->table;
+	unsigned int i, oldsize = old ? head->mask + 1 : 0;
+	struct ptrpair *table;
+
+	table = calloc(size, sizeof(*table));
+	if (!table)
+		die("out of memory");
+	for (i = 0; i < oldsize; i++) {
+		if (old[i].key)
+			*hash_slot(table, size - 1, old[i].key) = old[i];
+	}
+	free(old);
+	head->table = table;
+	head->mask = size - 1;
+}
+
+// set @key to @val, the old value is kept if @replace is false
+static void hash_set(struct ptrmap *head, void *key, void *val, int replace)
+{
+	struct ptrpair *pair = hash_slot(head->table, head->mask, key);
+
+	if (pair->key) {
+		if (replace)
+			pair->val = val;
+		return;
+	}
+	pair->key = key;
+	pair->val = val;
+	if (++head->count * 2 > head->mask + 1)
+		hash_resize(head, (head->mask + 1) * 2);
+}
+
+// move all the pairs of a map, in lookup order, into a new hash table
+static void hash_convert(struct ptrmap *head)
+{
+	struct ptrmap *map, *next;
+	unsigned int size = 16;
+	int i;
+
+	while (size < 2 * head->count)
+		size *= 2;
+	hash_resize(head, size);
+	head->count = 0;
+	for (map = head; map; map = map->next) {
+		for (i = 0; i < map->nr; i++)
+			hash_set(head, map->pairs[i].key, map->pairs[i].val, 0);
+	}
+	for (map = head->next; map; map = next) {
+		next = map->next;
+		__free_ptrmap(map);
+	}
+	head->next = NULL;
+	head->nr = 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
 void __ptrmap_add(struct ptrmap **mapp, void *key, void *val)
 {
 	struct ptrmap *head = *mapp;
@@ -50,6 +137,11 @@ void __ptrmap_add(struct ptrmap **mapp, void *key, void *val)
 	struct ptrpair *pair;
 	int nr;
 
+	if (head && head->table) {
+		hash_set(head, key, val, 0);
+		return;
+	}
+
 	if ((map = head)) {
 		struct ptrmap *next = map->next;
 		if (next)		// head is full
@@ -61,7 +153,7 @@ void __ptrmap_add(struct ptrmap **mapp, void *key, void *val)
 	// need a new block
 	newmap = __alloc_ptrmap(0);
 	if (!head) {
-		*mapp = newmap;
+		*mapp = head = newmap;
 	} else {
 		newmap->next = head->next;
 		head->next = newmap;
@@ -74,10 +166,17 @@ oldmap:
 	pair->key = key;
 	pair->val = val;
 	map->nr = ++nr;
+	if (++head->count > MAP_HASH_MIN)
+		hash_convert(head);
 }
 
 void *__ptrmap_lookup(struct ptrmap *map, void *key)
 {
+	if (map && map->table) {
+		struct ptrpair *pair = hash_slot(map->table, map->mask, key);
+		return pair->val;
+	}
+
 	for (; map; map = map->next) {
 		int i, n = map->nr;
 		for (i = 0; i < n; i++) {
@@ -93,6 +192,11 @@ void __ptrmap_update(struct ptrmap **mapp, void *key, void *val)
 {
 	struct ptrmap *map = *mapp;
 
+	if (map && map->table) {
+		hash_set(map, key, val, 1);
+		return;
+	}
+
 	for (; map; map = map->next) {
 		int i, n = map->nr;
 		for (i = 0; i < n; i++) {
@@ -107,3 +211,15 @@ void __ptrmap_update(struct ptrmap **mapp, void *key, void *val)
 
 	__ptrmap_add(mapp, key, val);
 }
+
+void __ptrmap_free(struct ptrmap **mapp)
+{
+	struct ptrmap *map, *next;
+
+	for (map = *mapp; map; map = next) {
+		next = map->next;
+		free(map->table);
+		__free_ptrmap(map);
+	}
+	*mapp = NULL;
+}
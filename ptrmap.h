@@ -19,10 +19,15 @@ struct ptrmap;
 		vtype val = __ptrmap_lookup((struct ptrmap*)map, k);	\
 		return val;						\
 	}								\
+	static inline							\
+	void name##_free(struct name **map) {				\
+		__ptrmap_free((struct ptrmap**)map);			\
+	}								\
 
 /* ptrmap.c */
 void __ptrmap_add(struct ptrmap **mapp, void *key, void *val);
 void __ptrmap_update(struct ptrmap **mapp, void *key, void *val);
 void *__ptrmap_lookup(struct ptrmap *map, void *key);
+void __ptrmap_free(struct ptrmap **mapp);
 
 #endif
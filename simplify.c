@@ -249,6 +249,126 @@ static int clean_up_phi(struct instruction *insn)
 	return if_convert_phi(insn);
 }
 
+///
+// Worklist
+// ^^^^^^^^
+//
+// With -fworklist, while optimize() is running, the instructions which
+// may have become simplifiable are marked as queued: the ones which have
+// changed, their users and the instructions they use, and the users of
+// a value which has lost some users.  So only those need to be visited
+// again instead of the whole function.
+
+static int worklist_enabled;
+
+///
+// enable or disable the queueing of instructions
+// @ep: the function being optimized
+// @enable: 0 to disable it, which also empties the worklist
+void set_worklist(struct entrypoint *ep, int enable)
+{
+	struct basic_block *bb;
+
+	worklist_enabled = enable;
+	if (enable)
+		return;
+	FOR_EACH_PTR(ep->bbs, bb) {
+		struct instruction *insn;
+
+		FOR_EACH_PTR(bb->insns, insn) {
+			insn->queued = 0;
+		} END_FOR_EACH_PTR(insn);
+	} END_FOR_EACH_PTR(bb);
+}
+
+///
+// queue an instruction to be simplified again
+void queue_insn(struct instruction *insn)
+{
+	if (!worklist_enabled || !insn->bb || insn->queued)
+		return;
+	insn->queued = 1;
+
+	// a phi-source is just a copy for its phi-node
+	if (insn->opcode == OP_PHISOURCE)
+		queue_users(insn->target);
+}
+
+///
+// queue all the users of a pseudo
+void queue_users(pseudo_t p)
+{
+	struct pseudo_user *pu;
+
+	if (!worklist_enabled || !has_use_list(p))
+		return;
+	FOR_EACH_PTR(p->users, pu) {
+		queue_insn(pu->insn);
+	} END_FOR_EACH_PTR(pu);
+}
+
+static void queue_operands(struct instruction *insn, int depth);
+
+static void queue_def(pseudo_t p, int depth)
+{
+	if (!p || !has_definition(p))
+		return;
+	queue_insn(p->def);
+	if (depth > 1)
+		queue_operands(p->def, depth - 1);
+}
+
+static void queue_operands(struct instruction *insn, int depth)
+{
+	pseudo_t src;
+
+	switch (insn->opcode) {
+	case OP_PHI:
+		FOR_EACH_PTR(insn->phi_list, src) {
+			if (src != VOID)
+				queue_def(src, depth);
+		} END_FOR_EACH_PTR(src);
+		break;
+
+	case OP_STORE:
+		queue_def(insn->target, depth);
+		/* fall through */
+	case OP_LOAD:
+		queue_def(insn->src, depth);
+		break;
+
+	case OP_SEL:
+		queue_def(insn->src3, depth);
+		/* fall through */
+	case OP_BINARY ... OP_BINCMP_END:
+		queue_def(insn->src2, depth);
+		/* fall through */
+	case OP_UNOP ... OP_UNOP_END:
+	case OP_SLICE:
+	case OP_PHISOURCE:
+		queue_def(insn->src1, depth);
+		break;
+
+	case OP_CBR:
+	case OP_SWITCH:
+	case OP_COMPUTEDGOTO:
+		queue_def(insn->cond, depth);
+		break;
+	}
+}
+
+///
+// queue the instructions defining the operands of an instruction
+//
+// Some simplifications rewrite in place the definition of an operand
+// or even the definition of one of its operands, so two levels are
+// queued.
+void queue_defs(struct instruction *insn)
+{
+	if (worklist_enabled)
+		queue_operands(insn, 2);
+}
+
 static int delete_pseudo_user_list_entry(struct pseudo_user_list **list, pseudo_t *entry, int count)
 {
 	struct pseudo_user *pu;
@@ -273,6 +393,11 @@ static inline void rem_usage(pseudo_t p, pseudo_t *usep, int kill)
 		delete_pseudo_user_list_entry(&p->users, usep, 1);
 		if (kill && !p->users && has_definition(p))
 			kill_instruction(p->def);
+		else if (worklist_enabled && has_definition(p)) {
+			queue_insn(p->def);
+			if (nbr_users(p) == 1)
+				queue_users(p);
+		}
 	}
 }
 
@@ -7,4 +7,9 @@ int simplify_instruction(struct instruction *insn);
 
 int replace_with_pseudo(struct instruction *insn, pseudo_t pseudo);
 
+void set_worklist(struct entrypoint *ep, int enable);
+void queue_insn(struct instruction *insn);
+void queue_users(pseudo_t p);
+void queue_defs(struct instruction *insn);
+
 #endif
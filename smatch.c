@@ -44,6 +44,9 @@ int option_disable = 0;
 int option_file_output;
 int option_time;
 int option_time_stmt;
+int option_time_returns;
+int option_hook_stats;
+int option_list_active_checks;
 int option_mem;
 char *option_datadir_str;
 int option_fatal_checks;
@@ -60,16 +63,31 @@ int __cur_check_id;
 
 bool __silence_warnings_for_stmt;
 
+#define REQ_KERNEL		(1 << 0)
+#define REQ_WINE		(1 << 1)
+#define REQ_ILLUMOS_KERNEL	(1 << 2)
+#define REQ_ILLUMOS_USER	(1 << 3)
+#define REQ_ILLUMOS		(REQ_ILLUMOS_KERNEL | REQ_ILLUMOS_USER)
+#define REQ_PROJECT_MASK	(REQ_KERNEL | REQ_WINE | REQ_ILLUMOS)
+#define REQ_INFO		(1 << 4)
+#define REQ_SPAMMY		(1 << 5)
+#define REQ_CALL_TREE		(1 << 6)
+#define REQ_TWO_PASSES		(1 << 7)
+
 typedef void (*reg_func) (int id);
 #define CK(_x) {.name = #_x, .func = &_x, .enabled = 0},
+#define CK_REQ(_x, _req) {.name = #_x, .func = &_x, .enabled = 0, .req = (_req)},
 static struct reg_func_info {
 	const char *name;
 	reg_func func;
 	int enabled;
+	int req;
+	bool registered;
 } reg_funcs[] = {
 	{"internal", NULL},
 #include "check_list.h"
 };
+#undef CK_REQ
 #undef CK
 int num_checks = ARRAY_SIZE(reg_funcs);
 
@@ -103,6 +121,54 @@ static void show_checks(void)
 	exit(0);
 }
 
+static int project_req(void)
+{
+	switch (option_project) {
+	case PROJ_KERNEL:
+		return REQ_KERNEL;
+	case PROJ_WINE:
+		return REQ_WINE;
+	case PROJ_ILLUMOS_KERNEL:
+		return REQ_ILLUMOS_KERNEL;
+	case PROJ_ILLUMOS_USER:
+		return REQ_ILLUMOS_USER;
+	default:
+		return 0;
+	}
+}
+
+static bool requirements_met(int req)
+{
+	if ((req & REQ_PROJECT_MASK) && !(req & project_req()))
+		return false;
+	if ((req & REQ_INFO) && !option_info)
+		return false;
+	if ((req & REQ_SPAMMY) && !option_spammy)
+		return false;
+	if ((req & REQ_CALL_TREE) && !option_call_tree)
+		return false;
+	if ((req & REQ_TWO_PASSES) && !option_two_passes)
+		return false;
+	return true;
+}
+
+static void list_active_checks(void)
+{
+	int registered = 0;
+	int i;
+
+	for (i = 1; i < ARRAY_SIZE(reg_funcs); i++) {
+		if (!reg_funcs[i].registered)
+			continue;
+		printf("%3d. %-45s %d hooks\n", i, reg_funcs[i].name,
+		       __hooks_owned_by(i));
+		registered++;
+	}
+	printf("%d of %d checks registered for project '%s'\n",
+	       registered, (int)ARRAY_SIZE(reg_funcs) - 1, option_project_str);
+	exit(0);
+}
+
 static void enable_disable_checks(char *s, bool enable)
 {
 	char buf[128];
@@ -150,9 +216,20 @@ static void help(void)
 	printf("--full-path:  print the full pathname.\n");
 	printf("--debug-implied:  print debug output about implications.\n");
 	printf("--assume-loops:  assume loops always go through at least once.\n");
-	printf("--two-passes:  use a two pass system for each function.\n");
+	printf("--two-passes:  use a two pass system for functions with loops or backwards gotos.\n");
+	printf("--callee-first:  parse the static functions a function calls before it.\n");
+	printf("--loop-fixpoint:  iterate loops until the ranges stop changing.\n");
+	printf("--goto-worklist:  iterate labels which are the target of backward gotos.\n");
 	printf("--file-output:  instead of printing stdout, print to \"file.c.smatch_out\".\n");
 	printf("--fatal-checks: check output is treated as an error.\n");
+	printf("--hook-stats:  print how often each type of hook was called.\n");
+	printf("--profile-checks[=file.json]:  print the time spent in each check.\n");
+	printf("--list-active-checks:  print the checks which are registered and exit.\n");
+	printf("--function-cache=<dir>:  reuse the output for functions which haven't changed.\n");
+	printf("--function-cache-verify=<percent>:  re-analyze some cached functions and compare.\n");
+	printf("--fast-path-verify=<percent>:  check that some trivial function returns would not be split.\n");
+	printf("--budget=<stage>=<limit>,...:  change when we give up on hairy functions.\n");
+	printf("--time-returns:  print how long each way of splitting the return states took.\n");
 	printf("--help:  print this helpful message.\n");
 	exit(1);
 }
@@ -243,6 +320,32 @@ void parse_args(int *argcp, char ***argvp)
 			(*argvp)[1] = (*argvp)[0];
 			found = 1;
 		}
+		if (!found && strncmp((*argvp)[1], "--profile-checks=", 17) == 0) {
+			option_profile_file = (*argvp)[1] + 17;
+			option_profile_checks = 1;
+			(*argvp)[1] = (*argvp)[0];
+			found = 1;
+		}
+		if (!found && strncmp((*argvp)[1], "--budget=", 9) == 0) {
+			option_budget = (*argvp)[1] + 9;
+			(*argvp)[1] = (*argvp)[0];
+			found = 1;
+		}
+		if (!found && strncmp((*argvp)[1], "--function-cache=", 17) == 0) {
+			option_function_cache = (*argvp)[1] + 17;
+			(*argvp)[1] = (*argvp)[0];
+			found = 1;
+		}
+		if (!found && strncmp((*argvp)[1], "--function-cache-verify=", 24) == 0) {
+			option_function_cache_verify = atoi((*argvp)[1] + 24);
+			(*argvp)[1] = (*argvp)[0];
+			found = 1;
+		}
+		if (!found && strncmp((*argvp)[1], "--fast-path-verify=", 19) == 0) {
+			option_fast_path_verify = atoi((*argvp)[1] + 19);
+			(*argvp)[1] = (*argvp)[0];
+			found = 1;
+		}
 		if (!found && strncmp((*argvp)[1], "--function=", 11) == 0) {
 			option_process_function = (*argvp)[1] + 11;
 			(*argvp)[1] = (*argvp)[0];
@@ -257,11 +360,18 @@ void parse_args(int *argcp, char ***argvp)
 		OPTION(assume_loops);
 		OPTION(no_data);
 		OPTION(two_passes);
+		OPTION(callee_first);
+		OPTION(loop_fixpoint);
+		OPTION(goto_worklist);
 		OPTION(full_path);
 		OPTION(call_tree);
 		OPTION(file_output);
 		OPTION(time);
 		OPTION(time_stmt);
+		OPTION(time_returns);
+		OPTION(hook_stats);
+		OPTION(profile_checks);
+		OPTION(list_active_checks);
 		OPTION(mem);
 		OPTION(no_db);
 		OPTION(succeed);
@@ -358,9 +468,10 @@ int main(int argc, char **argv)
 	sql_outfd = stdout;
 	caller_info_fd = stdout;
 
+	__function_cache_hash_args(argc, argv);
 	parse_args(&argc, &argv);
 
-	if (argc < 2)
+	if (argc < 2 && !option_list_active_checks)
 		help();
 
 	/* this gets set back to zero when we parse the first function */
@@ -384,15 +495,26 @@ int main(int argc, char **argv)
 		func = reg_funcs[i].func;
 		/* The script IDs start at 1.
 		   0 is used for internal stuff. */
+		if (!requirements_met(reg_funcs[i].req))
+			continue;
 		if (!option_enable || reg_funcs[i].enabled == 1 ||
 		    (option_disable && reg_funcs[i].enabled != -1) ||
-		    strncmp(reg_funcs[i].name, "register_", 9) == 0)
+		    strncmp(reg_funcs[i].name, "register_", 9) == 0) {
 			func(i);
+			reg_funcs[i].registered = true;
+		}
 	}
 	__cur_check_id = 0;
+	if (option_list_active_checks)
+		list_active_checks();
+	__build_hook_tables();
+	__init_budget();
+	__init_profiler();
+	__init_function_cache();
 
 	smatch(filelist);
 	free_string(data_dir);
+	report_stats();
 
 	if (option_succeed)
 		return 0;
@@ -483,7 +483,7 @@ struct stree *get_all_states_from_stree(int owner, struct stree *source);
 struct stree *get_all_states_stree(int id);
 struct stree *__get_cur_stree(void);
 int is_reachable(void);
-void add_get_state_hook(void (*fn)(int owner, const char *name, struct symbol *sym));
+void add_get_state_hook(int owner, void (*fn)(int owner, const char *name, struct symbol *sym));
 
 static inline void set_undefined(struct sm_state *sm, struct expression *mod_expr)
 {
@@ -614,7 +614,6 @@ bool get_offset_param(const char *ret_str, int *offset, int *param);
 /* smatch_points_to_container.c */
 struct expression *get_stored_container(struct expression *expr, int offset);
 
-int ms_since(struct timeval *start);
 int parent_is_gone_var_sym(const char *name, struct symbol *sym);
 int parent_is_gone(struct expression *expr);
 bool is_noderef_ptr(struct expression *expr);
@@ -725,14 +724,24 @@ void parse_assignment(struct expression *expr, bool shallow);
 void __split_expr(struct expression *expr);
 void __split_label_stmt(struct statement *stmt);
 void __split_stmt(struct statement *stmt);
+void __queue_inline_function(const char *name);
 extern int __in_function_def;
 extern int __in_unmatched_hook;
 extern int option_assume_loops;
 extern int option_two_passes;
+extern bool __skipped_first_pass;
+extern bool __trivial_function;
+extern unsigned long long __return_states_hash;
+extern int option_callee_first;
+extern int option_loop_fixpoint;
+extern int __in_loop_fixpoint;
+extern int option_goto_worklist;
 extern int option_no_db;
 extern int option_file_output;
 extern int option_time;
 extern int option_time_stmt;
+extern int option_time_returns;
+extern int option_hook_stats;
 extern struct expression_list *big_expression_stack;
 extern struct expression_list *big_condition_stack;
 extern struct statement_list *big_statement_stack;
@@ -917,7 +926,83 @@ typedef void (check_tracker_hook)(int owner, const char *name, struct symbol *sy
 void add_check_tracker(const char *check_name, check_tracker_hook *fn);
 
 /* smatch_hooks.c */
-void __pass_to_client(void *data, enum hook_type type);
+extern int __nr_hooks[NUM_HOOKS];
+void __build_hook_tables(void);
+int __hooks_owned_by(int owner);
+void __call_hooks(void *data, enum hook_type type);
+static inline void __pass_to_client(void *data, enum hook_type type)
+{
+	/* most hook types have nothing registered so skip the call */
+	if (!__nr_hooks[type])
+		return;
+	__call_hooks(data, type);
+}
+void __print_hook_stats(void);
+
+/* smatch_profile.c */
+enum profile_kind {
+	PROF_HOOK,
+	PROF_MERGE,
+	PROF_MODIFICATION,
+	PROF_FUNCTION_HOOK,
+	PROF_DB,
+	NUM_PROFILE_KINDS,
+};
+extern int option_profile_checks;
+extern char *option_profile_file;
+void __profile_enter(int owner, enum profile_kind kind);
+void __profile_leave(void);
+static inline void profile_enter(int owner, enum profile_kind kind)
+{
+	if (option_profile_checks)
+		__profile_enter(owner, kind);
+}
+static inline void profile_leave(void)
+{
+	if (option_profile_checks)
+		__profile_leave();
+}
+void __init_profiler(void);
+void __print_profile_report(void);
+
+/* smatch_function_cache.c */
+extern char *option_function_cache;
+extern int option_function_cache_verify;
+extern int option_fast_path_verify;
+void __function_cache_hash_args(int argc, char **argv);
+void __init_function_cache(void);
+bool __function_cache_lookup(struct symbol *sym);
+void __function_cache_add_inline(struct symbol *sym);
+void __function_cache_start(void);
+void __function_cache_sql(const char *sql);
+void __function_cache_finish(struct symbol *sym);
+void __print_function_cache_stats(void);
+void __print_two_pass_stats(void);
+void __print_loop_fixpoint_stats(void);
+void __print_goto_worklist_stats(void);
+void __print_trivial_function_stats(void);
+void __print_fast_path_stats(void);
+void __print_return_split_stats(void);
+
+/* smatch_budget.c */
+enum budget_stage {
+	BUDGET_FULL,
+	BUDGET_NO_PARAM_IMPLICATIONS,
+	BUDGET_NO_IMPLICATIONS,
+	BUDGET_NO_CALLER_INFO,
+	BUDGET_BAIL,
+};
+extern char *option_budget;
+void __init_budget(void);
+bool budget_exceeded(enum budget_stage stage);
+int budget_limit(enum budget_stage stage);
+bool budget_low_on_memory(void);
+bool budget_out_of_memory(void);
+void __budget_start_function(void);
+unsigned long long __budget_start_inline(void);
+void __budget_end_inline(unsigned long long orig);
+void __budget_record(void);
+
 void __pass_case_to_client(struct expression *switch_expr,
 			   struct range_list *rl);
 int __has_merge_function(int client_id);
@@ -996,6 +1081,8 @@ int is_recursive_member(const char *param_name);
 
 char *escape_newlines(const char *str);
 void sql_exec(struct sqlite3 *db, int (*callback)(void*, int, char**, char**), void *data, const char *sql);
+bool __replay_inline_summary(struct expression *call);
+void __save_inline_summary(struct expression *call);
 
 #define sql_helper(db, call_back, data, sql...)					\
 do {										\
@@ -1024,6 +1111,8 @@ do {										\
 do {										\
 	struct sqlite3 *_db = db;						\
 										\
+	if (__in_loop_fixpoint)							\
+		break;								\
 	if (__inline_fn && !_db)						\
 		_db = mem_db;							\
 	if (_db) {								\
@@ -1042,6 +1131,8 @@ do {										\
 			sm_ierror("SQL error #2: %s", err);			\
 			sm_ierror("SQL: '%s'", buf);				\
 			parse_error = 1;					\
+		} else if (_db == cache_db) {					\
+			__function_cache_sql(buf);				\
 		}								\
 		break;								\
 	}									\
@@ -1121,6 +1212,7 @@ extern int option_no_data;
 extern int option_full_path;
 extern int option_call_tree;
 extern int num_checks;
+extern int __cur_check_id;
 
 enum project_type {
 	PROJ_NONE,
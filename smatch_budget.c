@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2026 Oracle.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see http://www.gnu.org/copyleft/gpl.txt
+ */
+
+/*
+ * When a function is too hairy then we give up on the expensive stuff in
+ * stages.  First we stop doing implications for parameters, then we turn
+ * off implications completely, then we stop recording caller_info and last
+ * of all we give up on the function.
+ *
+ * The implication stages are based on how long we have been parsing the
+ * current function (inline functions get their own clock) and the later
+ * stages are based on the time since we started the outer function.  The
+ * sm_state limits bump us straight to the implications or bail stage.
+ *
+ * The limits can be changed with --budget=implications=30,bail=120 etc.
+ * When a function doesn't get the full treatment, the furthest stage
+ * which it reached is recorded in the DB as FUNC_BUDGET.
+ */
+
+#include <time.h>
+#include "smatch.h"
+#include "smatch_slist.h"
+
+char *option_budget;
+
+struct budget_limit {
+	const char *name;
+	int limit;
+};
+
+static struct budget_limit time_limits[] = {
+	[BUDGET_FULL] = { "full", 0 },
+	[BUDGET_NO_PARAM_IMPLICATIONS] = { "param_implications", 40 },
+	[BUDGET_NO_IMPLICATIONS] = { "implications", 60 },
+	[BUDGET_NO_CALLER_INFO] = { "caller_info", 120 },
+	[BUDGET_BAIL] = { "bail", 300 },
+};
+
+/* in MB of sm_states */
+static int low_mem_limit = 25;
+static int oom_limit = 100;
+
+static unsigned long long fn_start_ns;
+static unsigned long long outer_fn_start_ns;
+static enum budget_stage stage_reached;
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int secs_between(unsigned long long start, unsigned long long now)
+{
+	return (now - start) / 1000000000ULL;
+}
+
+int time_parsing_function(void)
+{
+	return secs_between(fn_start_ns, now_ns());
+}
+
+static unsigned long sm_state_mb(void)
+{
+	return sm_state_counter * sizeof(struct sm_state) / 1000000;
+}
+
+bool budget_low_on_memory(void)
+{
+	return sm_state_mb() >= low_mem_limit;
+}
+
+bool budget_out_of_memory(void)
+{
+	return sm_state_mb() >= oom_limit;
+}
+
+static enum budget_stage get_stage(void)
+{
+	unsigned long long now;
+	int fn_secs, outer_secs;
+
+	if (budget_out_of_memory())
+		return BUDGET_BAIL;
+
+	now = now_ns();
+	outer_secs = secs_between(outer_fn_start_ns, now);
+	if (outer_secs > time_limits[BUDGET_BAIL].limit)
+		return BUDGET_BAIL;
+	if (outer_secs >= time_limits[BUDGET_NO_CALLER_INFO].limit)
+		return BUDGET_NO_CALLER_INFO;
+
+	fn_secs = secs_between(fn_start_ns, now);
+	if (fn_secs >= time_limits[BUDGET_NO_IMPLICATIONS].limit)
+		return BUDGET_NO_IMPLICATIONS;
+	if (fn_secs > time_limits[BUDGET_NO_PARAM_IMPLICATIONS].limit)
+		return BUDGET_NO_PARAM_IMPLICATIONS;
+	return BUDGET_FULL;
+}
+
+bool budget_exceeded(enum budget_stage stage)
+{
+	enum budget_stage cur = get_stage();
+
+	if (cur > stage_reached)
+		stage_reached = cur;
+	return cur >= stage;
+}
+
+int budget_limit(enum budget_stage stage)
+{
+	return time_limits[stage].limit;
+}
+
+void __budget_start_function(void)
+{
+	outer_fn_start_ns = now_ns();
+	fn_start_ns = outer_fn_start_ns;
+	stage_reached = BUDGET_FULL;
+}
+
+unsigned long long __budget_start_inline(void)
+{
+	unsigned long long orig = fn_start_ns;
+
+	fn_start_ns = now_ns();
+	return orig;
+}
+
+void __budget_end_inline(unsigned long long orig)
+{
+	fn_start_ns = orig;
+}
+
+void __budget_record(void)
+{
+	if (__inline_fn || stage_reached == BUDGET_FULL)
+		return;
+	sql_insert_return_implies(FUNC_BUDGET, 0, "", time_limits[stage_reached].name);
+	if (option_time) {
+		final_pass++;
+		sm_msg("budget: %s", time_limits[stage_reached].name);
+		final_pass--;
+	}
+}
+
+static void set_limit(const char *name, int value)
+{
+	int i;
+
+	if (strcmp(name, "low_mem") == 0) {
+		low_mem_limit = value;
+		return;
+	}
+	if (strcmp(name, "oom") == 0) {
+		oom_limit = value;
+		return;
+	}
+	for (i = BUDGET_NO_PARAM_IMPLICATIONS; i < ARRAY_SIZE(time_limits); i++) {
+		if (strcmp(name, time_limits[i].name) == 0) {
+			time_limits[i].limit = value;
+			return;
+		}
+	}
+	sm_fatal("unknown budget stage '%s'", name);
+}
+
+void __init_budget(void)
+{
+	char *str, *next, *eq;
+
+	if (!option_budget)
+		return;
+
+	str = alloc_string(option_budget);
+	do {
+		next = strchr(str, ',');
+		if (next)
+			*next++ = '\0';
+		eq = strchr(str, '=');
+		if (!eq)
+			sm_fatal("bad --budget: '%s'", str);
+		*eq = '\0';
+		set_limit(str, atoi(eq + 1));
+	} while ((str = next));
+}
@@ -125,6 +125,7 @@ db_types = {
     1067: "ZERO_ERROR",
     1068: "LEAF_FN",
     1069: "CASTED_TO",
+    1070: "FUNC_BUDGET",
     2000: "SPLIT_LIMIT",
     2001: "NEXT_LIMIT",
     2002: "END_SPLIT",
@@ -19,6 +19,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <ctype.h>
+#include <time.h>
 #include "smatch.h"
 #include "smatch_slist.h"
 #include "smatch_extra.h"
@@ -33,6 +34,13 @@ static int my_id;
 
 static int return_id;
 
+/*
+ * A hash of the return states recorded for the current function.  The
+ * return_id keeps counting up so it is left out.  split_function() uses
+ * this to tell if the second pass recorded different return states.
+ */
+unsigned long long __return_states_hash;
+
 static void call_return_state_hooks(struct expression *expr);
 static void call_return_states_callbacks(const char *return_ranges, struct expression *expr);
 
@@ -40,6 +48,7 @@ static void call_return_states_callbacks(const char *return_ranges, struct expre
 
 struct def_callback {
 	int hook_type;
+	int owner;
 	void (*callback)(const char *name, struct symbol *sym, char *key, char *value);
 };
 ALLOCATOR(def_callback, "definition db hook callbacks");
@@ -48,6 +57,7 @@ static struct callback_list *select_caller_info_callbacks;
 
 struct def_name_sym_callback {
 	int hook_type;
+	int owner;
 	void (*callback)(const char *name, struct symbol *sym, char *value);
 };
 ALLOCATOR(def_name_sym_callback, "definition db hook callbacks");
@@ -76,6 +86,7 @@ DECLARE_PTR_LIST(return_info_cb_list, struct return_info_callback);
 static struct return_info_cb_list *return_callbacks;
 
 struct returned_state_callback {
+	int owner;
 	void (*callback)(int return_id, char *return_ranges, struct expression *return_expr);
 };
 ALLOCATOR(returned_state_callback, "returned state callbacks");
@@ -92,6 +103,7 @@ static struct returned_member_cb_list *returned_member_callbacks;
 
 struct db_implies_callback {
 	int type;
+	int owner;
 	void (*callback)(struct expression *call, struct expression *arg, char *key, char *value);
 };
 ALLOCATOR(db_implies_callback, "return_implies callbacks");
@@ -109,6 +121,93 @@ struct split_data {
 static struct split_data **forced_splits;
 static int split_count;
 
+int option_fast_path_verify;
+static int vanilla_returns;
+static int fast_path_returns, fast_path_verified, fast_path_mismatches;
+
+
+enum return_split {
+	SPLIT_BOOL,
+	SPLIT_CONDITION,
+	SPLIT_KERNEL_ERROR,
+	SPLIT_SUCCESS_FAIL,
+	SPLIT_POSSIBLE,
+	SPLIT_POSITIVE_NEGATIVE,
+	SPLIT_ZERO_NON_ZERO,
+	SPLIT_FUNCTION_CALL,
+	SPLIT_BOOL_PARAM,
+	SPLIT_NULL_PARAM,
+	SPLIT_IMPOSSIBLE,
+	SPLIT_VANILLA,
+	NUM_RETURN_SPLITS,
+};
+
+static const char *return_split_names[NUM_RETURN_SPLITS] = {
+	[SPLIT_BOOL] = "bool",
+	[SPLIT_CONDITION] = "condition",
+	[SPLIT_KERNEL_ERROR] = "kernel error path",
+	[SPLIT_SUCCESS_FAIL] = "success_fail",
+	[SPLIT_POSSIBLE] = "split_possible",
+	[SPLIT_POSITIVE_NEGATIVE] = "positive negative",
+	[SPLIT_ZERO_NON_ZERO] = "split zero non-zero",
+	[SPLIT_FUNCTION_CALL] = "split_function_call",
+	[SPLIT_BOOL_PARAM] = "bool param",
+	[SPLIT_NULL_PARAM] = "null non-null param",
+	[SPLIT_IMPOSSIBLE] = "split by impossible",
+	[SPLIT_VANILLA] = "vanilla",
+};
+
+static struct {
+	unsigned long long ns;
+	unsigned long long tries;
+	unsigned long long used;
+} return_split_stats[NUM_RETURN_SPLITS];
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * This is called after each of the return splitting strategies has been
+ * tried.  The time includes any nested returns from the condition split.
+ */
+static bool record_split(enum return_split split, bool used, unsigned long long *start)
+{
+	unsigned long long now;
+
+	if (option_time_returns) {
+		now = now_ns();
+		return_split_stats[split].ns += now - *start;
+		return_split_stats[split].tries++;
+		if (used)
+			return_split_stats[split].used++;
+		*start = now;
+	}
+	if (used && debug_db)
+		sm_msg("call_return_state_hooks: %s", return_split_names[split]);
+	return used;
+}
+
+void __print_return_split_stats(void)
+{
+	int i;
+
+	if (!option_time_returns)
+		return;
+
+	for (i = 0; i < NUM_RETURN_SPLITS; i++) {
+		if (!return_split_stats[i].tries)
+			continue;
+		sm_msg("returns: %-20s %10.3fms %8llu tries %8llu used",
+		       return_split_names[i], return_split_stats[i].ns / 1e6,
+		       return_split_stats[i].tries, return_split_stats[i].used);
+	}
+}
+
 /* silently truncates if needed. */
 char *escape_newlines(const char *str)
 {
@@ -226,17 +325,29 @@ static bool is_project_delete_return(struct expression *expr)
 }
 
 static char *use_states;
+/*
+ * Every split_*() function in call_return_state_hooks() checks this so it's
+ * counted once per return.
+ */
+static bool cache_db_state_count;
+static int db_state_count = -1;
+
 static int get_db_state_count(void)
 {
 	struct sm_state *sm;
 	int count = 0;
 
+	if (db_state_count >= 0)
+		return db_state_count;
+
 	FOR_EACH_SM(__get_cur_stree(), sm) {
 		if (sm->owner == USHRT_MAX)
 			continue;
 		if (use_states[sm->owner])
 			count++;
 	} END_FOR_EACH_SM(sm);
+	if (cache_db_state_count)
+		db_state_count = count;
 	return count;
 }
 
@@ -283,6 +394,15 @@ static void set_fn_mtag(struct symbol *sym)
 	__fn_mtag = str_to_mtag(buf);
 }
 
+static void hash_return_state(const char *str)
+{
+	if (!str)
+		str = "";
+	while (*str)
+		__return_states_hash = __return_states_hash * 31 + (unsigned char)*str++;
+	__return_states_hash = __return_states_hash * 31 + '|';
+}
+
 void sql_insert_return_states(int return_id, const char *return_ranges,
 		int type, int param, const char *key, const char *value)
 {
@@ -291,6 +411,13 @@ void sql_insert_return_states(int return_id, const char *return_ranges,
 
 	if (key && strlen(key) >= 80)
 		return;
+	if (!__inline_fn && !__in_loop_fixpoint) {
+		__return_states_hash = __return_states_hash * 31 + type;
+		__return_states_hash = __return_states_hash * 31 + param;
+		hash_return_state(return_ranges);
+		hash_return_state(key);
+		hash_return_state(value);
+	}
 	if (__inline_fn)
 		id = (unsigned long)__inline_fn;
 	else
@@ -299,6 +426,23 @@ void sql_insert_return_states(int return_id, const char *return_ranges,
 	sql_insert(return_states, "0x%llx, '%s', %llu, %d, '%s', %d, %d, %d, '%s', '%s'",
 		   get_base_file_id(), get_function(), id, return_id,
 		   return_ranges, is_local(cur_func_sym), type, param, key, value);
+
+	/*
+	 * With --callee-first the static functions are parsed before their
+	 * callers so save the return states for the callers to use.  Only
+	 * the final pass, like the printed rows.
+	 */
+	if (option_callee_first && final_pass && !__in_loop_fixpoint &&
+	    !__inline_fn && is_local(cur_func_sym)) {
+		char buf[1024];
+
+		snprintf(buf, sizeof(buf),
+			 "insert into return_states values (0x%llx, '%s', %llu, %d, '%s', %d, %d, %d, '%s', '%s');",
+			 get_base_file_id(), get_function(), id, return_id,
+			 return_ranges, 1, type, param, key, value);
+		cache_sql(NULL, NULL, "%s", buf);
+		__function_cache_sql(buf);
+	}
 }
 
 static struct string_list *common_funcs;
@@ -335,6 +479,8 @@ void sql_insert_caller_info(struct expression *call, int type,
 		return;
 	if (is_unreachable())
 		return;
+	if (budget_exceeded(BUDGET_NO_CALLER_INFO))
+		return;
 
 	if (key && strlen(key) >= 80)
 		return;
@@ -685,6 +831,24 @@ static void clear_incomplete(struct symbol *sym)
 		__db_incomplete = false;
 }
 
+static bool select_local_return_states(const char *cols, struct symbol *sym,
+	int (*callback)(void*, int, char**, char**), void *info)
+{
+	int row_count = 0;
+
+	if (!option_callee_first || !sym || !is_local(sym))
+		return false;
+
+	cache_sql(get_row_count, &row_count, "select count(*) from return_states where %s;",
+		  get_static_filter(sym));
+	if (row_count == 0)
+		return false;
+
+	cache_sql(callback, info, "select %s from return_states where %s order by file, return_id, type;",
+		  cols, get_static_filter(sym));
+	return true;
+}
+
 void sql_select_return_states(const char *cols, struct expression *call,
 	int (*callback)(void*, int, char**, char**), void *info)
 {
@@ -707,6 +871,9 @@ void sql_select_return_states(const char *cols, struct expression *call,
 		return;
 	}
 
+	if (select_local_return_states(cols, fn->symbol, callback, info))
+		return;
+
 	run_sql(get_row_count, &row_count, "select count(*) from return_states where %s;",
 		get_static_filter(fn->symbol));
 
@@ -814,6 +981,7 @@ void select_caller_info_hook(void (*callback)(const char *name, struct symbol *s
 	struct def_callback *def_callback = __alloc_def_callback(0);
 
 	def_callback->hook_type = type;
+	def_callback->owner = __cur_check_id;
 	def_callback->callback = callback;
 	add_ptr_list(&select_caller_info_callbacks, def_callback);
 }
@@ -823,6 +991,7 @@ void select_caller_name_sym(void (*fn)(const char *name, struct symbol *sym, cha
 	struct def_name_sym_callback *callback = __alloc_def_name_sym_callback(0);
 
 	callback->hook_type = type;
+	callback->owner = __cur_check_id;
 	callback->callback = fn;
 	add_ptr_list(&select_caller_name_sym_callbacks, callback);
 }
@@ -868,6 +1037,7 @@ void add_split_return_callback(void (*fn)(int return_id, char *return_ranges, st
 {
 	struct returned_state_callback *callback = __alloc_returned_state_callback(0);
 
+	callback->owner = __cur_check_id;
 	callback->callback = fn;
 	add_ptr_list(&returned_state_callbacks, callback);
 }
@@ -886,6 +1056,7 @@ void select_call_implies_hook(int type, void (*callback)(struct expression *call
 	struct db_implies_callback *cb = __alloc_db_implies_callback(0);
 
 	cb->type = type;
+	cb->owner = __cur_check_id;
 	cb->callback = callback;
 	add_ptr_list(&call_implies_cb_list, cb);
 }
@@ -895,6 +1066,7 @@ void select_return_implies_hook_early(int type, void (*callback)(struct expressi
 	struct db_implies_callback *cb = __alloc_db_implies_callback(0);
 
 	cb->type = type;
+	cb->owner = __cur_check_id;
 	cb->callback = callback;
 	add_ptr_list(&return_implies_cb_list_early, cb);
 }
@@ -904,6 +1076,7 @@ void select_return_implies_hook(int type, void (*callback)(struct expression *ca
 	struct db_implies_callback *cb = __alloc_db_implies_callback(0);
 
 	cb->type = type;
+	cb->owner = __cur_check_id;
 	cb->callback = callback;
 	add_ptr_list(&return_implies_cb_list_late, cb);
 }
@@ -1243,12 +1416,17 @@ static void match_call_info(struct expression *call)
 	struct expression *arg;
 	int i;
 
+	if (budget_exceeded(BUDGET_NO_CALLER_INFO))
+		return;
+
 	FOR_EACH_PTR(member_callbacks, cb) {
+		profile_enter(cb->owner, PROF_DB);
 		i = -1;
 		FOR_EACH_PTR(call->args, arg) {
 			i++;
 			print_struct_members(call, arg, i, cb->owner, cb->callback, 0);
 		} END_FOR_EACH_PTR(arg);
+		profile_leave();
 	} END_FOR_EACH_PTR(cb);
 }
 
@@ -1271,8 +1449,11 @@ static void match_call_info_new(struct expression *call)
 
 	if (!option_info && !__inline_call && !local_debug)
 		return;
+	if (budget_exceeded(BUDGET_NO_CALLER_INFO))
+		return;
 
 	FOR_EACH_PTR(member_callbacks_new, cb) {
+		profile_enter(cb->owner, PROF_DB);
 		i = -1;
 		FOR_EACH_PTR(call->args, arg) {
 			i++;
@@ -1283,6 +1464,7 @@ static void match_call_info_new(struct expression *call)
 			print_struct_members(call, tmp, i, cb->owner, cb->callback, 1);
 			__ignore_param_used--;
 		} END_FOR_EACH_PTR(arg);
+		profile_leave();
 	} END_FOR_EACH_PTR(cb);
 }
 
@@ -1378,8 +1560,11 @@ static int caller_info_callback(void *_data, int argc, char **argv, char **azCol
 		return 0;
 
 	FOR_EACH_PTR(select_caller_info_callbacks, def_callback) {
-		if (def_callback->hook_type == type)
-			def_callback->callback(name, sym, key, value);
+		if (def_callback->hook_type != type)
+			continue;
+		profile_enter(def_callback->owner, PROF_DB);
+		def_callback->callback(name, sym, key, value);
+		profile_leave();
 	} END_FOR_EACH_PTR(def_callback);
 
 	p = strchr(key, '$');
@@ -1389,8 +1574,11 @@ static int caller_info_callback(void *_data, int argc, char **argv, char **azCol
 		snprintf(fullname, sizeof(fullname), "%s", key);
 
 	FOR_EACH_PTR(select_caller_name_sym_callbacks, ns_callback) {
-		if (ns_callback->hook_type == type)
-			ns_callback->callback(fullname, sym, value);
+		if (ns_callback->hook_type != type)
+			continue;
+		profile_enter(ns_callback->owner, PROF_DB);
+		ns_callback->callback(fullname, sym, value);
+		profile_leave();
 	} END_FOR_EACH_PTR(ns_callback);
 
 	return 0;
@@ -1569,7 +1757,9 @@ static int return_implies_callbacks(void *_info, int argc, char **argv, char **a
 	FOR_EACH_PTR(info->cb_list, cb) {
 		if (cb->type != type)
 			continue;
+		profile_enter(cb->owner, PROF_DB);
 		cb->callback(info->expr, arg, argv[3], argv[4]);
+		profile_leave();
 	} END_FOR_EACH_PTR(cb);
 
 	return 0;
@@ -1600,7 +1790,9 @@ static int call_implies_callbacks(void *_info, int argc, char **argv, char **azC
 	FOR_EACH_PTR(info->cb_list, cb) {
 		if (cb->type != type)
 			continue;
+		profile_enter(cb->owner, PROF_DB);
 		cb->callback(info->expr, arg, argv[3], argv[4]);
+		profile_leave();
 	} END_FOR_EACH_PTR(cb);
 
 	return 0;
@@ -1913,7 +2105,9 @@ static void call_return_states_callbacks(const char *return_ranges, struct expre
 
 	return_id++;
 	FOR_EACH_PTR(returned_state_callbacks, cb) {
+		profile_enter(cb->owner, PROF_DB);
 		cb->callback(return_id, (char *)return_ranges, expr);
+		profile_leave();
 	} END_FOR_EACH_PTR(cb);
 }
 
@@ -2393,7 +2587,7 @@ static int splitable_function_call(struct expression *expr)
 	return split_possible_helper(sm, expr);
 }
 
-static struct sm_state *find_bool_param(void)
+static struct sm_state *__find_bool_param(void)
 {
 	struct stree *start_states;
 	struct symbol *arg;
@@ -2431,6 +2625,29 @@ found:
 	return sm;
 }
 
+/*
+ * The bool param only depends on the start states so look it up once per
+ * function.  The generation changes for every function and every inline.
+ */
+static int returns_generation;
+
+static void bump_returns_generation(void *unused)
+{
+	returns_generation++;
+}
+
+static struct sm_state *find_bool_param(void)
+{
+	static int generation = -1;
+	static struct sm_state *sm;
+
+	if (generation != returns_generation) {
+		sm = __find_bool_param();
+		generation = returns_generation;
+	}
+	return sm;
+}
+
 static int split_on_bool_sm(struct sm_state *sm, struct expression *expr)
 {
 	struct range_list *ret_rl;
@@ -2595,13 +2812,38 @@ static bool is_kernel_error_path(struct expression *expr)
 	return true;
 }
 
-static void call_return_state_hooks(struct expression *expr)
+/*
+ * If a param has more than one possible state coming from the callers then
+ * the split_by_*_param() functions can split the returns even for a trivial
+ * function.
+ */
+static bool has_splitable_param(void)
+{
+	struct symbol *arg;
+	struct sm_state *sm;
+
+	FOR_EACH_PTR(cur_func_sym->ctype.base_type->arguments, arg) {
+		if (!arg->ident)
+			continue;
+		sm = get_sm_state(SMATCH_EXTRA, arg->ident->name, arg);
+		if (sm && ptr_list_size((struct ptr_list *)sm->possible) > 1)
+			return true;
+	} END_FOR_EACH_PTR(arg);
+
+	return false;
+}
+
+static void split_return_states(struct expression *expr, bool fast_path)
 {
 	struct range_list *ret_rl;
 	const char *return_ranges;
+	unsigned long long start = 0;
 	int nr_states;
 	sval_t sval;
 
+	if (option_time_returns)
+		start = now_ns();
+
 	if (debug_db) {
 		struct range_list *rl = NULL;
 
@@ -2614,59 +2856,32 @@ static void call_return_state_hooks(struct expression *expr)
 	if (__path_is_null())
 		return;
 
-	if (is_impossible_path())
+	if (is_impossible_path() || fast_path)
 		goto vanilla;
 
 	if (expr && (expr->type == EXPR_COMPARE ||
 		     !get_implied_value(expr, &sval)) &&
 	    (is_condition(expr) || is_boolean_return(expr))) {
 		call_return_state_hooks_compare(expr);
-		if (debug_db)
-			sm_msg("%s: bool", __func__);
+		record_split(SPLIT_BOOL, true, &start);
 		return;
-	} else if (call_return_state_hooks_conditional(expr)) {
-		if (debug_db)
-			sm_msg("%s: condition", __func__);
+	}
+	if (record_split(SPLIT_CONDITION, call_return_state_hooks_conditional(expr), &start))
 		return;
-	} else if (is_kernel_error_path(expr)) {
-		if (debug_db)
-			sm_msg("%s: kernel error path", __func__);
+	if (record_split(SPLIT_KERNEL_ERROR, is_kernel_error_path(expr), &start))
 		goto vanilla;
-	} else if (call_return_state_hooks_split_success_fail(expr)) {
-		if (debug_db)
-			sm_msg("%s: success_fail", __func__);
-		return;
-	} else if (call_return_state_hooks_split_possible(expr)) {
-		if (debug_db)
-			sm_msg("%s: split_possible", __func__);
-		return;
-	} else if (split_positive_from_negative(expr)) {
-		if (debug_db)
-			sm_msg("%s: positive negative", __func__);
-		return;
-	} else if (call_return_state_hooks_split_null_non_null_zero(expr)) {
-		if (debug_db)
-			sm_msg("%s: split zero non-zero", __func__);
-		return;
-	} else if (splitable_function_call(expr)) {
-		if (debug_db)
-			sm_msg("%s: split_function_call", __func__);
-		return;
-	} else if (split_by_bool_param(expr)) {
-		if (debug_db)
-			sm_msg("%s: bool param", __func__);
-		return;
-	} else if (split_by_null_nonnull_param(expr)) {
-		if (debug_db)
-			sm_msg("%s: null non-null param", __func__);
+	if (record_split(SPLIT_SUCCESS_FAIL, call_return_state_hooks_split_success_fail(expr), &start) ||
+	    record_split(SPLIT_POSSIBLE, call_return_state_hooks_split_possible(expr), &start) ||
+	    record_split(SPLIT_POSITIVE_NEGATIVE, split_positive_from_negative(expr), &start) ||
+	    record_split(SPLIT_ZERO_NON_ZERO, call_return_state_hooks_split_null_non_null_zero(expr), &start) ||
+	    record_split(SPLIT_FUNCTION_CALL, splitable_function_call(expr), &start) ||
+	    record_split(SPLIT_BOOL_PARAM, split_by_bool_param(expr), &start) ||
+	    record_split(SPLIT_NULL_PARAM, split_by_null_nonnull_param(expr), &start) ||
+	    record_split(SPLIT_IMPOSSIBLE, split_by_impossible(expr), &start))
 		return;
-	} else if (split_by_impossible(expr)) {
-		if (debug_db)
-			sm_msg("%s: split by impossible", __func__);
-		return;
-	}
 
 vanilla:
+	vanilla_returns++;
 	return_ranges = get_return_ranges_str(expr, &ret_rl);
 	set_state(RETURN_ID, "return_ranges", NULL, alloc_estate_rl(ret_rl));
 
@@ -2679,8 +2894,44 @@ vanilla:
 		return;
 	}
 	call_return_states_callbacks(return_ranges, expr);
-	if (debug_db)
-		sm_msg("%s: vanilla", __func__);
+	record_split(SPLIT_VANILLA, true, &start);
+}
+
+static void call_return_state_hooks(struct expression *expr)
+{
+	int orig_vanilla = vanilla_returns;
+	bool orig_cache = cache_db_state_count;
+	int orig_count = db_state_count;
+
+	cache_db_state_count = true;
+	db_state_count = -1;
+
+	if (!__trivial_function || __path_is_null() || has_splitable_param()) {
+		split_return_states(expr, false);
+	} else if (option_fast_path_verify &&
+		   rand() % 100 < option_fast_path_verify) {
+		fast_path_verified++;
+		split_return_states(expr, false);
+		if (vanilla_returns == orig_vanilla) {
+			fast_path_mismatches++;
+			fprintf(stderr, "fast path: %s:%d %s() return states were split\n",
+				get_filename(), get_lineno(), get_function());
+		}
+	} else {
+		fast_path_returns++;
+		split_return_states(expr, true);
+	}
+
+	cache_db_state_count = orig_cache;
+	db_state_count = orig_count;
+}
+
+void __print_fast_path_stats(void)
+{
+	if (!option_time || (!fast_path_returns && !fast_path_verified))
+		return;
+	sm_msg("fast path: returns: %d verified: %d mismatches: %d",
+	       fast_path_returns, fast_path_verified, fast_path_mismatches);
 }
 
 static void print_returned_struct_members(int return_id, char *return_ranges, struct expression *expr)
@@ -2701,6 +2952,7 @@ static void print_returned_struct_members(int return_id, char *return_ranges, st
 
 	len = strlen(name);
 	FOR_EACH_PTR(returned_member_callbacks, cb) {
+		profile_enter(cb->owner, PROF_DB);
 		FOR_EACH_MY_SM(cb->owner, __get_cur_stree(), sm) {
 			if (sm->name[0] == '*' && strcmp(sm->name + 1, name) == 0) {
 				strcpy(member_name, "*$");
@@ -2714,6 +2966,7 @@ static void print_returned_struct_members(int return_id, char *return_ranges, st
 			snprintf(member_name, sizeof(member_name), "$%s", sm->name + len);
 			cb->callback(return_id, return_ranges, expr, member_name, sm->state);
 		} END_FOR_EACH_SM(sm);
+		profile_leave();
 	} END_FOR_EACH_PTR(cb);
 
 	free_string(name);
@@ -2762,12 +3015,199 @@ static void print_return_info(int return_id, char *return_ranges, struct express
 	sym = expr_to_sym(expr);
 
 	FOR_EACH_PTR(return_callbacks, cb) {
+		profile_enter(cb->owner, PROF_DB);
 		__ignore_param_used++;
 		print_return_struct_info(return_id, return_ranges, expr, sym, cb);
 		__ignore_param_used--;
+		profile_leave();
 	} END_FOR_EACH_PTR(cb);
 }
 
+/*
+ * Small static functions are parsed again at every call site which calls
+ * them.  Afterwards the caller only looks at the return_states and the
+ * return_implies that parse_inline() put in the mem_db for that call.  So
+ * if we have already parsed the function with the same caller_info then we
+ * can copy those rows instead.  The caller_info is compared without the
+ * file, caller and call_id columns.
+ */
+struct inline_summary {
+	struct symbol *sym;
+	char *caller_info;
+	struct string_list *rows;
+	struct inline_summary *next;
+};
+
+#define INLINE_SUMMARY_BUCKETS 1024
+static struct inline_summary *inline_summaries[INLINE_SUMMARY_BUCKETS];
+static char *inline_caller_info;
+static struct string_list *inline_rows;
+
+static int save_caller_info_row(void *_buf, int argc, char **argv, char **azColName)
+{
+	char **buf = _buf;
+	char *old = *buf;
+	int i;
+
+	*buf = sqlite3_mprintf("%s", old ? old : "");
+	sqlite3_free(old);
+	for (i = 0; i < argc; i++) {
+		old = *buf;
+		*buf = sqlite3_mprintf("%s%Q%s", old, argv[i], i + 1 < argc ? "|" : "\n");
+		sqlite3_free(old);
+	}
+	return 0;
+}
+
+static char *get_inline_caller_info(struct expression *call)
+{
+	char *buf = NULL;
+	char *ret;
+
+	mem_sql(save_caller_info_row, &buf,
+		"select function, static, type, parameter, key, value from caller_info "
+		"where call_id = '%lu' order by type, parameter, key, value;",
+		(unsigned long)call);
+	ret = alloc_string(buf ? buf : "");
+	sqlite3_free(buf);
+	return ret;
+}
+
+static unsigned int inline_summary_bucket(struct symbol *sym, const char *caller_info)
+{
+	unsigned long hash = (unsigned long)sym;
+	const char *p;
+
+	for (p = caller_info; *p; p++)
+		hash = hash * 33 + *p;
+	return hash % INLINE_SUMMARY_BUCKETS;
+}
+
+/*
+ * The rows are saved as two strings, the part before the call_id and the
+ * part after it.
+ */
+static int save_inline_row(void *_table, int argc, char **argv, char **azColName)
+{
+	char *before, *after, *old, *str;
+	int i;
+
+	before = sqlite3_mprintf("insert into %s values (", (char *)_table);
+	after = sqlite3_mprintf("");
+	for (i = 0; i < argc; i++) {
+		if (i == 2)
+			continue;
+		if (i < 2) {
+			old = before;
+			before = sqlite3_mprintf("%s%Q, ", old, argv[i]);
+		} else {
+			old = after;
+			after = sqlite3_mprintf("%s, %Q", old, argv[i]);
+		}
+		sqlite3_free(old);
+	}
+	str = alloc_string(before);
+	add_ptr_list(&inline_rows, str);
+	old = after;
+	after = sqlite3_mprintf("%s);", old);
+	sqlite3_free(old);
+	str = alloc_string(after);
+	add_ptr_list(&inline_rows, str);
+	sqlite3_free(before);
+	sqlite3_free(after);
+	return 0;
+}
+
+bool __replay_inline_summary(struct expression *call)
+{
+	struct inline_summary *summary;
+	struct symbol *sym = call->fn->symbol;
+	char *before = NULL;
+	char *after, *sql;
+
+	free_string(inline_caller_info);
+	inline_caller_info = get_inline_caller_info(call);
+
+	summary = inline_summaries[inline_summary_bucket(sym, inline_caller_info)];
+	for (; summary; summary = summary->next) {
+		if (summary->sym == sym &&
+		    strcmp(summary->caller_info, inline_caller_info) == 0)
+			break;
+	}
+	if (!summary)
+		return false;
+
+	sm_debug("inline summary:  %s\n", sym->ident ? sym->ident->name : "");
+	FOR_EACH_PTR(summary->rows, after) {
+		if (!before) {
+			before = after;
+			continue;
+		}
+		sql = sqlite3_mprintf("%s%lu%s", before, (unsigned long)call, after);
+		if (sql)
+			sql_exec(mem_db, NULL, NULL, sql);
+		sqlite3_free(sql);
+		before = NULL;
+	} END_FOR_EACH_PTR(after);
+	return true;
+}
+
+void __save_inline_summary(struct expression *call)
+{
+	struct inline_summary *summary;
+	unsigned int bucket;
+	char *str;
+
+	if (!inline_caller_info)
+		return;
+
+	inline_rows = NULL;
+	mem_sql(save_inline_row, (void *)"return_states",
+		"select * from return_states where call_id = '%lu';", (unsigned long)call);
+	mem_sql(save_inline_row, (void *)"return_implies",
+		"select * from return_implies where call_id = '%lu';", (unsigned long)call);
+
+	summary = malloc(sizeof(*summary));
+	if (!summary) {
+		free_string(inline_caller_info);
+		FOR_EACH_PTR(inline_rows, str) {
+			free_string(str);
+		} END_FOR_EACH_PTR(str);
+		free_ptr_list(&inline_rows);
+		inline_caller_info = NULL;
+		return;
+	}
+	summary->sym = call->fn->symbol;
+	summary->caller_info = inline_caller_info;
+	summary->rows = inline_rows;
+	bucket = inline_summary_bucket(summary->sym, summary->caller_info);
+	summary->next = inline_summaries[bucket];
+	inline_summaries[bucket] = summary;
+
+	inline_caller_info = NULL;
+	inline_rows = NULL;
+}
+
+static void free_inline_summaries(struct symbol_list *sym_list)
+{
+	struct inline_summary *summary, *next;
+	char *str;
+	int i;
+
+	for (i = 0; i < INLINE_SUMMARY_BUCKETS; i++) {
+		for (summary = inline_summaries[i]; summary; summary = next) {
+			next = summary->next;
+			free_string(summary->caller_info);
+			FOR_EACH_PTR(summary->rows, str) {
+				free_string(str);
+			} END_FOR_EACH_PTR(str);
+			free_ptr_list(&summary->rows);
+			free(summary);
+		}
+		inline_summaries[i] = NULL;
+	}
+}
+
 static void reset_memdb(struct symbol *sym)
 {
 	mem_sql(NULL, NULL, "delete from caller_info;");
@@ -2870,6 +3310,7 @@ static void init_cachedb(void)
 		"db/mtag_info.schema",
 		"db/sink_info.schema",
 		"db/hash_string.schema",
+		"db/return_states.schema",
 	};
 	static char buf[4096];
 	int fd;
@@ -3187,6 +3628,8 @@ void register_definition_db_callbacks(int id)
 	add_hook(&match_data_from_db, FUNC_DEF_HOOK);
 	add_hook(&match_call_implies, FUNC_DEF_HOOK);
 	add_hook(&clear_incomplete, FUNC_DEF_HOOK);
+	add_hook(&bump_returns_generation, FUNC_DEF_HOOK);
+	add_hook(&bump_returns_generation, INLINE_FN_END);
 	add_hook(&match_return_implies_early, CALL_HOOK_AFTER_INLINE);
 
 	common_funcs = load_strings_from_file(option_project_str, "common_functions");
@@ -3195,6 +3638,7 @@ void register_definition_db_callbacks(int id)
 	register_forced_return_splits();
 
 	add_hook(&dump_cache, END_FILE_HOOK);
+	add_hook(&free_inline_summaries, END_FILE_HOOK);
 }
 
 void register_definition_db_callbacks_late(int id)
@@ -67,8 +67,6 @@ static struct expression_list *parsed_calls;
 static int indent_cnt;
 int __in_pre_condition = 0;
 int __bail_on_rest_of_function = 0;
-static struct timeval fn_start_time;
-static struct timeval outer_fn_start_time;
 char *get_function(void) { return cur_func; }
 int get_lineno(void) { return __smatch_lineno; }
 int inside_loop(void) { return !!loop_count; }
@@ -83,9 +81,22 @@ static void split_args(struct expression *expr);
 static struct expression *fake_a_variable_assign(struct symbol *type, struct expression *call, struct expression *expr, int nr);
 static void add_inline_function(struct symbol *sym);
 static void parse_inline(struct expression *expr);
+static void save_flow_state(void);
+static void restore_flow_state(void);
+static void clear_function_data(void);
 
 int option_assume_loops = 0;
 int option_two_passes = 0;
+bool __skipped_first_pass;
+bool __trivial_function;
+static int trivial_funcs;
+static int two_pass_funcs, one_pass_funcs, two_pass_changed;
+int option_callee_first;
+int option_loop_fixpoint;
+int __in_loop_fixpoint;
+static int fixpoint_loops, fixpoint_iterations, fixpoint_widened, fixpoint_dropped;
+int option_goto_worklist;
+static int goto_regions, goto_reanalyzed;
 struct symbol *cur_func_sym = NULL;
 struct stree *global_states;
 
@@ -320,6 +331,8 @@ int inlinable(struct expression *expr)
 
 	if (__inline_fn)  /* don't nest */
 		return 0;
+	if (__in_loop_fixpoint)
+		return 0;
 
 	if (expr->type != EXPR_SYMBOL || !expr->symbol)
 		return 0;
@@ -327,14 +340,14 @@ int inlinable(struct expression *expr)
 		return 0;
 	sym = get_base_type(expr->symbol);
 	if (sym->stmt && sym->stmt->type == STMT_COMPOUND) {
-		if (ptr_list_size((struct ptr_list *)sym->stmt->stmts) > 10)
+		if (ptr_list_counted_size((struct ptr_list *)sym->stmt->stmts) > 10)
 			return 0;
 		if (sym->stmt->type != STMT_COMPOUND)
 			return 0;
 		last_stmt = last_ptr_list((struct ptr_list *)sym->stmt->stmts);
 	}
 	if (sym->inline_stmt && sym->inline_stmt->type == STMT_COMPOUND) {
-		if (ptr_list_size((struct ptr_list *)sym->inline_stmt->stmts) > 10)
+		if (ptr_list_counted_size((struct ptr_list *)sym->inline_stmt->stmts) > 10)
 			return 0;
 		if (sym->inline_stmt->type != STMT_COMPOUND)
 			return 0;
@@ -1021,6 +1034,439 @@ static bool is_scoped_guard_goto(struct statement *iterator, struct statement *p
 	return true;
 }
 
+/*
+ * With --loop-fixpoint we parse the loop body silently to find the
+ * SMATCH_EXTRA states on the back edge and merge them into the states at the
+ * start of the loop.  We keep doing that until nothing changes.  For the
+ * first WIDEN_AFTER iterations the ranges are just merged, after that a
+ * range which is still growing is widened to the end of the type in the
+ * direction that it grew.  After MAX_FIXPOINT_ITERATIONS we give up and
+ * set whatever is still changing to the whole range.  If anything was
+ * widened then we do one more pass from the widened states and narrow them
+ * back to the start states plus the back edge states, because a widened
+ * range like 0-s32max usually comes back as 0-10 once the loop condition
+ * has been applied.  Then the loop is parsed for real starting from those
+ * states.  The iterator of a canonical loop is not touched because
+ * smatch_extra already knows its range.
+ *
+ * The silent passes don't do inlining or DB inserts and they can't nest.
+ */
+#define WIDEN_AFTER 2
+#define MAX_FIXPOINT_ITERATIONS 5
+
+static int silent_pass_bail;
+
+static void start_silent_pass(struct stree *head)
+{
+	silent_pass_bail = __bail_on_rest_of_function;
+
+	save_flow_state();
+	save_all_states();
+	clear_function_data();
+	big_statement_stack = NULL;
+	big_expression_stack = NULL;
+	big_condition_stack = NULL;
+	switch_expr_stack = NULL;
+	parsed_calls = NULL;
+	__swap_cur_stree(clone_stree(head));
+	__in_loop_fixpoint++;
+	final_pass = 0;
+	/*
+	 * Don't let smatch_extra widen the increments in the body, the back
+	 * edge is widened by merge_back_edge().
+	 */
+	loop_count = 0;
+	__push_scope_hooks();
+}
+
+static struct stree *end_silent_pass(struct position pos)
+{
+	struct stree *back = NULL;
+
+	if (!__path_is_null())
+		back = get_all_states_stree(SMATCH_EXTRA);
+
+	__free_scope_hooks();
+	nullify_path();
+	free_goto_stack();
+	free_expression_stack(&big_expression_stack);
+	free_expression_stack(&switch_expr_stack);
+	free_expression_stack(&parsed_calls);
+	__free_ptr_list((struct ptr_list **)&big_statement_stack);
+	__in_loop_fixpoint--;
+	restore_all_states();
+	restore_flow_state();
+	__bail_on_rest_of_function = silent_pass_bail;
+	set_position(pos);
+
+	return back;
+}
+
+static struct stree *loop_back_edge_states(struct statement *stmt, struct stree *head,
+					   struct stree *canonical)
+{
+	struct sm_state *sm;
+
+	start_silent_pass(head);
+
+	__push_continues();
+	__push_breaks();
+	if (stmt->type == STMT_ITERATOR && stmt->iterator_pre_condition) {
+		if (implied_condition_false(stmt->iterator_pre_condition))
+			nullify_path();
+		__split_whole_condition(stmt->iterator_pre_condition);
+		__discard_false_states();
+	}
+	FOR_EACH_SM(canonical, sm) {
+		set_state(sm->owner, sm->name, sm->sym, sm->state);
+	} END_FOR_EACH_SM(sm);
+	__split_stmt(stmt->iterator_statement);
+	__merge_continues();
+	if (stmt->iterator_post_statement)
+		__split_stmt(stmt->iterator_post_statement);
+	if (stmt->iterator_post_condition &&
+	    !expr_is_zero(stmt->iterator_post_condition)) {
+		if (implied_condition_false(stmt->iterator_post_condition))
+			nullify_path();
+		__split_whole_condition(stmt->iterator_post_condition);
+		__discard_false_states();
+	}
+
+	return end_silent_pass(stmt->pos);
+}
+
+static struct range_list *widen_rl(struct range_list *old, struct range_list *new)
+{
+	struct symbol *type = rl_type(old);
+	sval_t min = rl_min(new);
+	sval_t max = rl_max(new);
+
+	if (sval_cmp(rl_min(new), rl_min(old)) < 0)
+		min = sval_type_min(type);
+	if (sval_cmp(rl_max(new), rl_max(old)) > 0)
+		max = sval_type_max(type);
+	return alloc_rl(min, max);
+}
+
+/*
+ * Merge the back edge states into the head.  Returns the number of states
+ * which changed.  Only the states whose range grew are touched.  The new
+ * range is merged into the head state with merge_sm_states() so that the
+ * implications of the head state are kept.  The back edge states themselves
+ * are not used because their implications point into the silent pass.
+ * The iterator of a canonical loop is left alone, smatch_extra sets it.
+ */
+static int merge_back_edge(struct stree **head, struct stree *back,
+			   const char *iter_name, struct symbol *iter_sym,
+			   int iterations, int *widened, int *dropped)
+{
+	struct sm_state *sm, *orig, *new;
+	struct range_list *rl, *orig_rl;
+	struct symbol *type;
+	int changed = 0;
+
+	FOR_EACH_SM(back, sm) {
+		if (iter_name && iter_sym == sm->sym &&
+		    strcmp(iter_name, sm->name) == 0)
+			continue;
+		orig = get_sm_state_stree(*head, SMATCH_EXTRA, sm->name, sm->sym);
+		if (!orig || !estate_rl(orig->state) || !estate_rl(sm->state))
+			continue;
+		orig_rl = estate_rl(orig->state);
+		rl = rl_union(orig_rl, cast_rl(rl_type(orig_rl), estate_rl(sm->state)));
+		if (rl_equiv(rl, orig_rl))
+			continue;
+		type = rl_type(orig_rl);
+		if (iterations == MAX_FIXPOINT_ITERATIONS) {
+			rl = alloc_whole_rl(type);
+			(*dropped)++;
+		} else if (iterations > WIDEN_AFTER) {
+			rl = widen_rl(orig_rl, rl);
+			(*widened)++;
+		}
+		new = alloc_sm_state(SMATCH_EXTRA, sm->name, sm->sym,
+				     alloc_estate_rl(rl));
+		new = merge_sm_states(orig, new);
+		overwrite_sm_state_stree(head, new);
+		changed++;
+	} END_FOR_EACH_SM(sm);
+
+	return changed;
+}
+
+/*
+ * The current states are still the states from before the loop.  The ranges
+ * which we widened are replaced with the start range plus the back edge
+ * range if that is smaller.
+ */
+static void narrow_head(struct stree **head, struct stree *back)
+{
+	struct sm_state *sm, *orig, *cur, *new;
+	struct range_list *rl, *cur_rl;
+
+	FOR_EACH_SM(back, sm) {
+		orig = get_sm_state(SMATCH_EXTRA, sm->name, sm->sym);
+		cur = get_sm_state_stree(*head, SMATCH_EXTRA, sm->name, sm->sym);
+		if (!orig || !cur || cur == orig)
+			continue;
+		if (!estate_rl(orig->state) || !estate_rl(cur->state) ||
+		    !estate_rl(sm->state))
+			continue;
+		cur_rl = estate_rl(cur->state);
+		rl = rl_union(estate_rl(orig->state),
+			      cast_rl(rl_type(cur_rl), estate_rl(sm->state)));
+		if (rl_equiv(rl, cur_rl) || !rl_equiv(rl_union(rl, cur_rl), cur_rl))
+			continue;
+		new = alloc_sm_state(SMATCH_EXTRA, sm->name, sm->sym,
+				     alloc_estate_rl(rl));
+		new = merge_sm_states(orig, new);
+		overwrite_sm_state_stree(head, new);
+	} END_FOR_EACH_SM(sm);
+}
+
+/*
+ * The head was cloned from the current states so anything which is still the
+ * same sm_state wasn't changed by merge_back_edge().
+ */
+static void set_head_states(struct stree *head)
+{
+	struct sm_state *sm, *orig;
+
+	FOR_EACH_SM(head, sm) {
+		if (sm->owner != SMATCH_EXTRA)
+			continue;
+		orig = get_sm_state(SMATCH_EXTRA, sm->name, sm->sym);
+		if (orig && orig != sm)
+			__set_sm(sm);
+	} END_FOR_EACH_SM(sm);
+}
+
+/*
+ * The "i" in "do { ... } while (i++ < 3);" is handled by handle_postop_inc()
+ * in smatch_extra.c.
+ */
+static char *post_loop_iterator(struct statement *stmt, struct symbol **sym)
+{
+	struct expression *cond, *left;
+
+	if (stmt->iterator_pre_condition)
+		return NULL;
+	cond = strip_expr(stmt->iterator_post_condition);
+	if (!cond || cond->type != EXPR_COMPARE)
+		return NULL;
+	left = strip_expr(cond->left);
+	if (left->type != EXPR_POSTOP || left->op != SPECIAL_INCREMENT)
+		return NULL;
+	return expr_to_var_sym(left->unop, sym);
+}
+
+static void loop_fixpoint(struct statement *stmt)
+{
+	struct stree *head, *back, *canonical = NULL;
+	struct sm_state *iterator;
+	struct symbol *iter_sym = NULL;
+	char *iter_name;
+	int iterations = 0;
+	int widened = 0;
+	int dropped = 0;
+	int changed;
+
+	if (!option_loop_fixpoint || __in_loop_fixpoint || __inline_fn ||
+	    __path_is_null() || !stmt->iterator_statement)
+		return;
+
+	iterator = __extra_handle_canonical_loops(stmt, &canonical);
+	if (iterator) {
+		iter_name = alloc_string(iterator->name);
+		iter_sym = iterator->sym;
+	} else {
+		iter_name = post_loop_iterator(stmt, &iter_sym);
+	}
+	head = clone_stree(__get_cur_stree());
+	do {
+		iterations++;
+		back = loop_back_edge_states(stmt, head, canonical);
+		changed = merge_back_edge(&head, back, iter_name, iter_sym,
+					  iterations, &widened, &dropped);
+		free_stree(&back);
+	} while (changed && iterations < MAX_FIXPOINT_ITERATIONS);
+
+	if (widened || dropped) {
+		back = loop_back_edge_states(stmt, head, canonical);
+		narrow_head(&head, back);
+		free_stree(&back);
+	}
+
+	set_head_states(head);
+	free_stree(&head);
+	free_stree(&canonical);
+	free_string(iter_name);
+
+	fixpoint_loops++;
+	fixpoint_iterations += iterations;
+	fixpoint_widened += widened;
+	fixpoint_dropped += dropped;
+	sm_debug("loop fixpoint: iterations = %d widened = %d dropped = %d\n",
+		 iterations, widened, dropped);
+}
+
+void __print_loop_fixpoint_stats(void)
+{
+	if (!option_loop_fixpoint || !option_time)
+		return;
+	sm_msg("loop fixpoint: loops: %d iterations: %d widened: %d dropped: %d",
+	       fixpoint_loops, fixpoint_iterations, fixpoint_widened,
+	       fixpoint_dropped);
+}
+
+/*
+ * With --goto-worklist a label which is the target of a goto further down
+ * in the same block is treated like the head of a loop.  The region from
+ * the label to the last statement with a "goto label" is parsed silently
+ * and the states from the backward gotos are merged into the states at the
+ * label.  The region is only parsed again when that changes the states at
+ * the label, and it uses the same widening, narrowing and iteration limits
+ * as --loop-fixpoint.
+ */
+static bool same_stmt_pos(struct position a, struct position b)
+{
+	return a.stream == b.stream && a.line == b.line && a.pos == b.pos;
+}
+
+static struct statement *backward_goto_region_end(struct statement *compound,
+						  struct statement *label_stmt)
+{
+	struct ident *label = label_stmt->label_identifier->ident;
+	struct statement *region_end = NULL;
+	struct statement *cur, *next, *tmp;
+	struct token *token, *end;
+	int idx = -1;
+	int i = 0;
+
+	FOR_EACH_PTR(compound->stmts, tmp) {
+		if (tmp == label_stmt)
+			idx = i;
+		i++;
+	} END_FOR_EACH_PTR(tmp);
+	if (idx < 0)
+		return NULL;
+
+	/* for the function body the position is the function name */
+	token = preprocessed_token_at(compound->pos);
+	if (!token)
+		return NULL;
+	end = function_end_token(token);
+	if (!end)
+		return NULL;
+	token = preprocessed_token_at(label_stmt->pos);
+	if (!token)
+		return NULL;
+
+	cur = label_stmt;
+	next = ptr_list_nth_entry((struct ptr_list *)compound->stmts, ++idx);
+	for (; token != end && !eof_token(token); token = token->next) {
+		if (next && same_stmt_pos(token->pos, next->pos)) {
+			cur = next;
+			next = ptr_list_nth_entry((struct ptr_list *)compound->stmts, ++idx);
+		}
+		if (token_type(token) != TOKEN_IDENT ||
+		    token->ident != &goto_ident)
+			continue;
+		if (token_type(token->next) == TOKEN_IDENT &&
+		    token->next->ident == label)
+			region_end = cur;
+	}
+
+	return region_end;
+}
+
+static struct stree *goto_back_edge_states(struct statement *compound,
+					   struct statement *label_stmt,
+					   struct statement *region_end,
+					   struct stree *head)
+{
+	struct symbol *label = label_stmt->label_identifier;
+	struct statement *tmp;
+	bool inside = false;
+
+	start_silent_pass(head);
+
+	FOR_EACH_PTR(compound->stmts, tmp) {
+		if (tmp == label_stmt) {
+			inside = true;
+			/* the states from the earlier gotos are in the head */
+			__split_stmt(tmp->label_statement);
+		} else if (inside) {
+			__split_stmt(tmp);
+		}
+		if (tmp == region_end)
+			inside = false;
+	} END_FOR_EACH_PTR(tmp);
+
+	nullify_path();
+	__merge_gotos(label->ident->name, label);
+
+	return end_silent_pass(label_stmt->pos);
+}
+
+static void goto_worklist(struct statement *compound, struct statement *label_stmt)
+{
+	struct statement *region_end;
+	struct stree *head, *back;
+	struct symbol *label;
+	int iterations = 0;
+	int widened = 0;
+	int dropped = 0;
+	int changed;
+
+	if (!option_goto_worklist || __in_loop_fixpoint || __inline_fn)
+		return;
+	label = label_stmt->label_identifier;
+	if (!label || label->type != SYM_LABEL || !label->ident)
+		return;
+
+	region_end = backward_goto_region_end(compound, label_stmt);
+	if (!region_end)
+		return;
+
+	/* forward gotos are merged here and again by __split_label_stmt() */
+	__merge_gotos(label->ident->name, label);
+	if (__path_is_null())
+		return;
+
+	head = clone_stree(__get_cur_stree());
+	do {
+		iterations++;
+		back = goto_back_edge_states(compound, label_stmt, region_end, head);
+		changed = merge_back_edge(&head, back, NULL, NULL,
+					  iterations, &widened, &dropped);
+		free_stree(&back);
+	} while (changed && iterations < MAX_FIXPOINT_ITERATIONS);
+
+	if (widened || dropped) {
+		iterations++;
+		back = goto_back_edge_states(compound, label_stmt, region_end, head);
+		narrow_head(&head, back);
+		free_stree(&back);
+	}
+
+	set_head_states(head);
+	free_stree(&head);
+
+	goto_regions++;
+	goto_reanalyzed += iterations - 1;
+	sm_debug("goto worklist: %s: passes = %d widened = %d dropped = %d\n",
+		 label->ident->name, iterations, widened, dropped);
+}
+
+void __print_goto_worklist_stats(void)
+{
+	if (!option_goto_worklist || !option_time)
+		return;
+	sm_msg("goto worklist: regions: %d re-analyzed: %d",
+	       goto_regions, goto_reanalyzed);
+}
+
 /*
  * Pre Loops are while and for loops.
  */
@@ -1052,6 +1498,7 @@ static void handle_pre_loop(struct statement *stmt)
 
 	__pass_to_client(stmt, PRELOOP_HOOK);
 
+	loop_fixpoint(stmt);
 	extra_sm = __extra_handle_canonical_loops(stmt, &stree);
 	__in_pre_condition++;
 	__set_confidence_implied();
@@ -1142,6 +1589,7 @@ static void handle_post_loop(struct statement *stmt)
 
 	__pass_to_client(stmt, POSTLOOP_HOOK);
 
+	loop_fixpoint(stmt);
 	__push_continues();
 	__push_breaks();
 	__merge_gotos(loop_name, NULL);
@@ -1312,16 +1760,9 @@ next:
 	__split_stmt(stmt->case_statement);
 }
 
-int time_parsing_function(void)
-{
-	return ms_since(&fn_start_time) / 1000;
-}
-
 bool taking_too_long(void)
 {
-	if ((ms_since(&outer_fn_start_time) / 1000) > 60 * 5) /* five minutes */
-		return 1;
-	return 0;
+	return budget_exceeded(BUDGET_BAIL);
 }
 
 struct statement *get_last_stmt(void)
@@ -1486,6 +1927,8 @@ static void split_compound(struct statement *stmt)
 			__prev_stmt = prev;
 			__next_stmt = next;
 			__cur_stmt = cur;
+			if (cur->type == STMT_LABEL)
+				goto_worklist(stmt, cur);
 			__split_stmt(cur);
 		}
 		prev = cur;
@@ -1495,6 +1938,8 @@ static void split_compound(struct statement *stmt)
 		__prev_stmt = prev;
 		__cur_stmt = cur;
 		__next_stmt = NULL;
+		if (cur->type == STMT_LABEL)
+			goto_worklist(stmt, cur);
 		__split_stmt(cur);
 	}
 
@@ -1592,13 +2037,11 @@ void __split_stmt(struct statement *stmt)
 		return;
 
 	if (out_of_memory() || taking_too_long()) {
-		gettimeofday(&start, NULL);
-
 		__bail_on_rest_of_function = 1;
 		final_pass = 1;
 		if (option_spammy)
-			sm_perror("Function too hairy.  Giving up. %lu seconds",
-			       start.tv_sec - fn_start_time.tv_sec);
+			sm_perror("Function too hairy.  Giving up. %d seconds",
+			       time_parsing_function());
 		fake_a_return();
 		final_pass = 0;  /* turn off sm_msg() from here */
 		return;
@@ -2260,12 +2703,10 @@ static void clear_function_data(void)
 
 static void record_func_time(void)
 {
-	struct timeval stop;
 	int func_time;
 	char buf[32];
 
-	gettimeofday(&stop, NULL);
-	func_time = stop.tv_sec - fn_start_time.tv_sec;
+	func_time = time_parsing_function();
 	snprintf(buf, sizeof(buf), "%d", func_time);
 	sql_insert_return_implies(FUNC_TIME, 0, "", buf);
 	if (option_time && func_time > 2) {
@@ -2273,17 +2714,129 @@ static void record_func_time(void)
 		sm_msg("func_time: %d", func_time);
 		final_pass--;
 	}
+	__budget_record();
+}
+
+static bool is_label_token(struct token *prev, struct token *token)
+{
+	if (token_type(token) != TOKEN_IDENT || !match_op(token->next, ':'))
+		return false;
+	return match_op(prev, ';') || match_op(prev, '{') ||
+	       match_op(prev, '}') || match_op(prev, ':');
+}
+
+/*
+ * The first pass only matters when there is a way to jump backwards,
+ * because that's how the states from later in the function get to code
+ * which we've already parsed.  So look for loops and for gotos to a label
+ * which came earlier.  Computed gotos could go anywhere.  If we can't find
+ * the tokens then play it safe.
+ */
+static bool needs_two_passes(struct symbol *sym)
+{
+	struct ident_list *labels = NULL;
+	struct token *token, *prev, *end;
+	struct ident *label;
+	bool ret = false;
+
+	token = function_start_token(sym->pos, sym->ident);
+	if (!token)
+		return true;
+	end = function_end_token(token);
+	if (!end)
+		return true;
+
+	for (prev = token; token != end; prev = token, token = token->next) {
+		if (token_type(token) != TOKEN_IDENT)
+			continue;
+		if (token->ident == &for_ident ||
+		    token->ident == &while_ident ||
+		    token->ident == &do_ident) {
+			ret = true;
+			break;
+		}
+		if (is_label_token(prev, token)) {
+			add_ptr_list(&labels, token->ident);
+			continue;
+		}
+		if (token->ident != &goto_ident)
+			continue;
+		if (token_type(token->next) != TOKEN_IDENT) {
+			ret = true;
+			break;
+		}
+		FOR_EACH_PTR(labels, label) {
+			if (label == token->next->ident) {
+				ret = true;
+				goto done;
+			}
+		} END_FOR_EACH_PTR(label);
+	}
+done:
+	free_ptr_list(&labels);
+	return ret;
+}
+
+/*
+ * A trivial function is one where the body is just "return;" or a return of
+ * a constant.  There is nothing to split the return states on, so
+ * call_return_state_hooks() can go straight to the vanilla return.  A
+ * return of a function call doesn't count because the return states are
+ * split based on what the callee returns.
+ */
+static bool is_trivial_function(struct symbol *base_type)
+{
+	struct statement *stmt;
+	struct expression *expr;
+
+	stmt = base_type->stmt;
+	if (!stmt)
+		stmt = base_type->inline_stmt;
+	if (!stmt || stmt->type != STMT_COMPOUND)
+		return false;
+	if (ptr_list_size((struct ptr_list *)stmt->stmts) > 1)
+		return false;
+
+	stmt = first_ptr_list((struct ptr_list *)stmt->stmts);
+	if (!stmt)
+		return true;
+	if (stmt->type != STMT_RETURN)
+		return false;
+
+	expr = strip_expr(stmt->ret_value);
+	if (!expr)
+		return true;
+	if (expr->type == EXPR_PREOP && expr->op == '-')
+		expr = strip_expr(expr->unop);
+	return expr->type == EXPR_VALUE;
+}
+
+void __print_trivial_function_stats(void)
+{
+	if (!option_time || !trivial_funcs)
+		return;
+	sm_msg("trivial functions: %d", trivial_funcs);
+}
+
+void __print_two_pass_stats(void)
+{
+	if (!option_two_passes || !option_time)
+		return;
+	sm_msg("two passes: %d functions, skipped first pass: %d, second pass changed the return states: %d",
+	       two_pass_funcs, one_pass_funcs, two_pass_changed);
 }
 
 static void split_function(struct symbol *sym)
 {
+	unsigned long long first_pass_hash = 0;
+	bool two_passes = false;
+
 	struct symbol *base_type = get_base_type(sym);
 
 	if (!base_type->stmt && !base_type->inline_stmt)
 		return;
 
-	gettimeofday(&outer_fn_start_time, NULL);
-	gettimeofday(&fn_start_time, NULL);
+	__budget_start_function();
 	cur_func_sym = sym;
 	if (sym->ident)
 		cur_func = sym->ident->name;
@@ -2291,12 +2844,29 @@ static void split_function(struct symbol *sym)
 	    strcmp(option_process_function, cur_func) != 0)
 		return;
 	set_position(sym->pos);
+	if (__function_cache_lookup(sym)) {
+		sym->parsed = true;
+		cur_func_sym = NULL;
+		cur_func = NULL;
+		return;
+	}
+	__function_cache_start();
 	clear_function_data();
 	loop_count = 0;
 	last_goto_statement_handled = 0;
 	sm_debug("new function:  %s\n", cur_func);
 	__stree_id = 0;
-	if (option_two_passes) {
+	__skipped_first_pass = false;
+	__trivial_function = is_trivial_function(base_type);
+	if (__trivial_function)
+		trivial_funcs++;
+	if (option_two_passes && !needs_two_passes(sym)) {
+		__skipped_first_pass = true;
+		one_pass_funcs++;
+	} else if (option_two_passes) {
+		two_pass_funcs++;
+		two_passes = true;
+		__return_states_hash = 0;
 		__unnullify_path();
 		loop_num = 0;
 		final_pass = 0;
@@ -2304,12 +2874,16 @@ static void split_function(struct symbol *sym)
 		parse_fn_statements(base_type);
 		do_scope_hooks();
 		nullify_path();
+		first_pass_hash = __return_states_hash;
 	}
+	__return_states_hash = 0;
 	__unnullify_path();
 	loop_num = 0;
 	final_pass = 1;
 	start_function_definition(sym);
 	parse_fn_statements(base_type);
+	if (two_passes && __return_states_hash != first_pass_hash)
+		two_pass_changed++;
 	if (!__path_is_null() &&
 	    cur_func_return_type() == &void_ctype &&
 	    !__bail_on_rest_of_function) {
@@ -2325,6 +2899,7 @@ static void split_function(struct symbol *sym)
 	clear_all_states();
 
 	record_func_time();
+	__function_cache_finish(sym);
 
 	cur_func_sym = NULL;
 	cur_func = NULL;
@@ -2397,8 +2972,9 @@ void parse_inline(struct expression *call)
 {
 	struct symbol *base_type;
 	char *cur_func_bak = cur_func;  /* not aligned correctly for backup */
-	struct timeval time_backup = fn_start_time;
+	unsigned long long time_backup;
 	struct expression *orig_inline = __inline_fn;
+	bool orig_trivial = __trivial_function;
 	int orig_budget;
 
 	if (out_of_memory() || taking_too_long())
@@ -2407,9 +2983,12 @@ void parse_inline(struct expression *call)
 	if (already_parsed_call(call))
 		return;
 
+	if (__replay_inline_summary(call))
+		return;
+
 	save_flow_state();
 
-	gettimeofday(&fn_start_time, NULL);
+	time_backup = __budget_start_inline();
 	__pass_to_client(call, INLINE_FN_START);
 	final_pass = 0;  /* don't print anything */
 	__inline_fn = call;
@@ -2417,6 +2996,7 @@ void parse_inline(struct expression *call)
 	inline_budget = inline_budget - 5;
 
 	base_type = get_base_type(call->fn->symbol);
+	__trivial_function = is_trivial_function(base_type);
 	cur_func_sym = call->fn->symbol;
 	if (call->fn->symbol->ident)
 		cur_func = call->fn->symbol->ident->name;
@@ -2456,14 +3036,16 @@ void parse_inline(struct expression *call)
 	free_goto_stack();
 
 	record_func_time();
+	__save_inline_summary(call);
 
 	restore_flow_state();
-	fn_start_time = time_backup;
+	__budget_end_inline(time_backup);
 	cur_func = cur_func_bak;
 
 	restore_all_states();
 	set_position(call->pos);
 	__inline_fn = orig_inline;
+	__trivial_function = orig_trivial;
 	inline_budget = orig_budget;
 	__pass_to_client(call, INLINE_FN_END);
 }
@@ -2474,6 +3056,8 @@ static void add_inline_function(struct symbol *sym)
 	static struct symbol_list *already_added;
 	struct symbol *tmp;
 
+	__function_cache_add_inline(sym);
+
 	FOR_EACH_PTR(already_added, tmp) {
 		if (tmp == sym)
 			return;
@@ -2483,6 +3067,24 @@ static void add_inline_function(struct symbol *sym)
 	add_ptr_list(&inlines_called, sym);
 }
 
+/*
+ * When a function is replayed from the function cache then its body isn't
+ * parsed so queue the inline functions it called by hand.  The file scope
+ * is still there so we can look them up by name.
+ */
+void __queue_inline_function(const char *name)
+{
+	struct symbol *sym;
+
+	sym = lookup_symbol(built_in_ident(name), NS_SYMBOL);
+	if (!sym || sym->type != SYM_NODE || get_base_type(sym)->type != SYM_FN)
+		return;
+	sym = sym->definition;
+	if (!sym || !(sym->ctype.modifiers & MOD_INLINE))
+		return;
+	add_inline_function(sym);
+}
+
 static void process_inlines(void)
 {
 	struct symbol *tmp;
@@ -2586,9 +3188,125 @@ static struct stree *clone_estates_perm(struct stree *orig)
 	return ret;
 }
 
+/*
+ * For --callee-first we want to parse the functions in the file so that
+ * the callees come before the callers.  Then the return_states from static
+ * callees are already in the cache_db when we get to the caller.
+ *
+ * The call graph comes from the preprocessed tokens: every "ident (" in the
+ * tokens of a function where ident is a function defined in this file.  The
+ * sym->aux pointer isn't used by Smatch so we use that to point from the
+ * function to the node.
+ */
+struct call_graph_node {
+	struct symbol *sym;
+	struct symbol_list *callees;
+	bool visited;
+};
+
+static struct call_graph_node *get_node(struct symbol *sym)
+{
+	struct call_graph_node *node = sym->aux;
+
+	if (node && node->sym == sym)
+		return node;
+	return NULL;
+}
+
+static void add_callee(struct call_graph_node *caller, struct ident *ident)
+{
+	struct symbol *sym, *tmp;
+
+	for (sym = ident->symbols; sym; sym = sym->next_id) {
+		if (sym == caller->sym || !get_node(sym))
+			continue;
+		FOR_EACH_PTR(caller->callees, tmp) {
+			if (tmp == sym)
+				return;
+		} END_FOR_EACH_PTR(tmp);
+		add_ptr_list(&caller->callees, sym);
+		return;
+	}
+}
+
+static void build_call_graph(struct symbol_list *fns)
+{
+	struct token *token, *end;
+	struct symbol *sym;
+
+	FOR_EACH_PTR(fns, sym) {
+		token = function_start_token(sym->pos, sym->ident);
+		if (!token)
+			continue;
+		end = function_end_token(token);
+		if (!end)
+			continue;
+		for (; token != end; token = token->next) {
+			if (token_type(token) == TOKEN_IDENT &&
+			    match_op(token->next, '('))
+				add_callee(get_node(sym), token->ident);
+		}
+	} END_FOR_EACH_PTR(sym);
+}
+
+static void add_callees_first(struct symbol *sym, struct symbol_list **order)
+{
+	struct call_graph_node *node = get_node(sym);
+	struct symbol *callee;
+
+	if (node->visited)
+		return;
+	node->visited = true;
+
+	FOR_EACH_PTR(node->callees, callee) {
+		add_callees_first(callee, order);
+	} END_FOR_EACH_PTR(callee);
+
+	add_ptr_list(order, sym);
+}
+
+static struct symbol_list *get_callee_first_order(struct symbol_list *sym_list)
+{
+	struct symbol_list *fns = NULL;
+	struct symbol_list *order = NULL;
+	struct call_graph_node *node;
+	struct symbol *sym, *base;
+
+	FOR_EACH_PTR(sym_list, sym) {
+		base = get_base_type(sym);
+		if (sym->type != SYM_NODE || base->type != SYM_FN)
+			continue;
+		if (!base->stmt && !base->inline_stmt)
+			continue;
+		if (!interesting_function(sym))
+			continue;
+		node = calloc(1, sizeof(*node));
+		node->sym = sym;
+		sym->aux = node;
+		add_ptr_list(&fns, sym);
+	} END_FOR_EACH_PTR(sym);
+
+	build_call_graph(fns);
+
+	FOR_EACH_PTR(fns, sym) {
+		add_callees_first(sym, &order);
+	} END_FOR_EACH_PTR(sym);
+
+	FOR_EACH_PTR(fns, sym) {
+		node = sym->aux;
+		free_ptr_list(&node->callees);
+		free(node);
+		sym->aux = NULL;
+	} END_FOR_EACH_PTR(sym);
+	free_ptr_list(&fns);
+
+	return order;
+}
+
 struct position last_pos;
 static void split_c_file_functions(struct symbol_list *sym_list)
 {
+	struct symbol_list *fn_list = NULL;
 	struct symbol *sym;
 
 	__unnullify_path();
@@ -2603,7 +3321,10 @@ static void split_c_file_functions(struct symbol_list *sym_list)
 	global_states = clone_estates_perm(get_all_states_stree(SMATCH_EXTRA));
 	nullify_path();
 
-	FOR_EACH_PTR(sym_list, sym) {
+	if (option_callee_first)
+		fn_list = get_callee_first_order(sym_list);
+
+	FOR_EACH_PTR(fn_list ?: sym_list, sym) {
 		set_position(sym->pos);
 		last_pos = sym->pos;
 		if (!interesting_function(sym))
@@ -2614,6 +3335,7 @@ static void split_c_file_functions(struct symbol_list *sym_list)
 		}
 		last_pos = sym->pos;
 	} END_FOR_EACH_PTR(sym);
+	free_ptr_list(&fn_list);
 	split_inlines(sym_list);
 	__pass_to_client(sym_list, END_FILE_HOOK);
 }
@@ -2693,4 +3415,14 @@ void smatch(struct string_list *filelist)
 		sm_msg("time: %lu", stop.tv_sec - start.tv_sec);
 	if (option_mem)
 		sm_msg("mem: %luKb", get_max_memory());
+	if (option_hook_stats)
+		__print_hook_stats();
+	__print_function_cache_stats();
+	__print_two_pass_stats();
+	__print_trivial_function_stats();
+	__print_fast_path_stats();
+	__print_return_split_stats();
+	__print_loop_fixpoint_stats();
+	__print_goto_worklist_stats();
+	__print_profile_report();
 }
@@ -0,0 +1,498 @@
+/*
+ * Copyright (C) 2026 Oracle.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see http://www.gnu.org/copyleft/gpl.txt
+ */
+
+/*
+ * This is for --function-cache=<dir>.  The idea is that when we re-run Smatch
+ * over the same tree every night most of the functions haven't changed so we
+ * can just print the same output as last time.
+ *
+ * The key for a function is a hash of:
+ * 1) The smatch binary and the command line options.
+ * 2) The file name and the preprocessed tokens of the function (including
+ *    the line numbers because those are printed in the warnings).
+ * 3) The return_states in the DB for everything the function calls and the
+ *    caller_info for the function itself.
+ *
+ * When we analyze a function we point sm_outfd, sql_outfd and caller_info_fd
+ * at memory buffers and we also record the inserts into the cache_db and the
+ * static inline functions which it queued to be analyzed afterwards.  That
+ * gets saved as <dir>/<key> and on the next run we just print it out again
+ * and queue the same inline functions.
+ *
+ * Anything which is collected over the whole file and printed from the
+ * END_FILE_HOOK wouldn't see the functions we skipped.  That's mostly the
+ * --info output which is used to build the DB so with --info the cache is
+ * not used at all.
+ *
+ * With --function-cache-verify=<percent> we re-analyze that percent of the
+ * functions where we found a cache entry and complain if the output is
+ * different.
+ */
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include "token.h"
+#include "smatch.h"
+
+char *option_function_cache;
+int option_function_cache_verify;
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+enum {
+	BUF_OUT,
+	BUF_SQL,
+	BUF_CALLER_INFO,
+	BUF_CACHE_DB,
+	BUF_INLINES,
+	NUM_BUFS,
+};
+
+struct capture {
+	char *buf[NUM_BUFS];
+	size_t len[NUM_BUFS];
+	int nr_checks;
+	int nr_errors;
+};
+
+static unsigned long long config_hash = FNV_OFFSET;
+
+static bool recording;
+static bool verifying;
+static unsigned long long cur_key;
+static FILE *capture_fd[NUM_BUFS];
+static FILE *orig_fd[BUF_CACHE_DB];
+static struct capture cached, fresh;
+static int start_checks, start_errors;
+static struct symbol_list *recorded_inlines;
+
+static int hits, misses, verified, mismatches;
+
+static unsigned long long hash_bytes(unsigned long long hash, const void *p, size_t len)
+{
+	const unsigned char *s = p;
+
+	while (len--) {
+		hash ^= *s++;
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+static unsigned long long hash_str(unsigned long long hash, const char *str)
+{
+	if (!str)
+		str = "(null)";
+	return hash_bytes(hash, str, strlen(str) + 1);
+}
+
+static unsigned long long hash_int(unsigned long long hash, int val)
+{
+	return hash_bytes(hash, &val, sizeof(val));
+}
+
+static void hash_binary(void)
+{
+	char buf[4096];
+	FILE *fp;
+	size_t len;
+
+	fp = fopen("/proc/self/exe", "r");
+	if (!fp)
+		return;
+	while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+		config_hash = hash_bytes(config_hash, buf, len);
+	fclose(fp);
+}
+
+void __function_cache_hash_args(int argc, char **argv)
+{
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (argv[i][0] != '-')
+			continue;
+		if (strncmp(argv[i], "--function-cache", 16) == 0)
+			continue;
+		config_hash = hash_str(config_hash, argv[i]);
+	}
+}
+
+static int hash_row(void *_hash, int argc, char **argv, char **azColName)
+{
+	unsigned long long *hash = _hash;
+	int i;
+
+	for (i = 0; i < argc; i++)
+		*hash = hash_str(*hash, argv[i]);
+	return 0;
+}
+
+static bool has_ident(struct ident_list *list, struct ident *ident)
+{
+	struct ident *tmp;
+
+	FOR_EACH_PTR(list, tmp) {
+		if (tmp == ident)
+			return true;
+	} END_FOR_EACH_PTR(tmp);
+	return false;
+}
+
+static bool get_function_key(struct symbol *sym, unsigned long long *key)
+{
+	struct ident_list *callees = NULL;
+	struct ident *ident;
+	struct token *token, *end;
+	unsigned long long hash = config_hash;
+	int start_line = sym->pos.line;
+
+	if (!sym->ident)
+		return false;
+	token = function_start_token(sym->pos, sym->ident);
+	if (!token)
+		return false;
+	end = function_end_token(token);
+	if (!end)
+		return false;
+
+	hash = hash_str(hash, get_base_file());
+	hash = hash_str(hash, get_filename());
+	hash = hash_str(hash, sym->ident->name);
+	hash = hash_int(hash, start_line);
+	hash = hash_int(hash, sym->pos.pos);
+	hash = hash_str(hash, type_to_str(get_real_base_type(sym)));
+
+	for (; token != end->next; token = token->next) {
+		hash = hash_int(hash, token->pos.line - start_line);
+		hash = hash_str(hash, show_token(token));
+
+		if (token_type(token) == TOKEN_IDENT &&
+		    match_op(token->next, '(') &&
+		    !has_ident(callees, token->ident))
+			add_ptr_list(&callees, token->ident);
+	}
+
+	FOR_EACH_PTR(callees, ident) {
+		run_sql(hash_row, &hash,
+			"select * from return_states where function = '%s';",
+			ident->name);
+	} END_FOR_EACH_PTR(ident);
+	free_ptr_list(&callees);
+
+	run_sql(hash_row, &hash,
+		"select * from caller_info where function = '%s';",
+		sym->ident->name);
+
+	*key = hash;
+	return true;
+}
+
+static char *cache_filename(unsigned long long key)
+{
+	static char buf[PATH_MAX];
+
+	snprintf(buf, sizeof(buf), "%s/%016llx", option_function_cache, key);
+	return buf;
+}
+
+static void free_capture(struct capture *capture)
+{
+	int i;
+
+	for (i = 0; i < NUM_BUFS; i++) {
+		free(capture->buf[i]);
+		capture->buf[i] = NULL;
+		capture->len[i] = 0;
+	}
+}
+
+static bool load_entry(unsigned long long key, struct capture *capture)
+{
+	char header[128];
+	FILE *fp;
+	int i;
+
+	fp = fopen(cache_filename(key), "r");
+	if (!fp)
+		return false;
+
+	if (!fgets(header, sizeof(header), fp))
+		goto bad;
+	if (sscanf(header, "smatch function cache %d %d %zu %zu %zu %zu %zu",
+		   &capture->nr_checks, &capture->nr_errors,
+		   &capture->len[0], &capture->len[1],
+		   &capture->len[2], &capture->len[3],
+		   &capture->len[4]) != 7)
+		goto bad;
+
+	for (i = 0; i < NUM_BUFS; i++) {
+		capture->buf[i] = malloc(capture->len[i] + 1);
+		if (fread(capture->buf[i], 1, capture->len[i], fp) != capture->len[i])
+			goto bad;
+		capture->buf[i][capture->len[i]] = '\0';
+	}
+	fclose(fp);
+	return true;
+bad:
+	fclose(fp);
+	free_capture(capture);
+	return false;
+}
+
+static void save_entry(unsigned long long key, struct capture *capture)
+{
+	char tmp[PATH_MAX];
+	FILE *fp;
+	int i;
+
+	/* several smatch processes can share a cache so rename() it into place */
+	snprintf(tmp, sizeof(tmp), "%s.%d", cache_filename(key), getpid());
+	fp = fopen(tmp, "w");
+	if (!fp)
+		return;
+
+	fprintf(fp, "smatch function cache %d %d %zu %zu %zu %zu %zu\n",
+		capture->nr_checks, capture->nr_errors,
+		capture->len[0], capture->len[1],
+		capture->len[2], capture->len[3],
+		capture->len[4]);
+	for (i = 0; i < NUM_BUFS; i++)
+		fwrite(capture->buf[i], 1, capture->len[i], fp);
+	if (fclose(fp) != 0) {
+		unlink(tmp);
+		return;
+	}
+	if (rename(tmp, cache_filename(key)))
+		unlink(tmp);
+}
+
+static void replay_cache_db(struct capture *capture)
+{
+	char *p = capture->buf[BUF_CACHE_DB];
+	char *end = p + capture->len[BUF_CACHE_DB];
+	char *err = NULL;
+
+	while (p < end) {
+		if (sqlite3_exec(cache_db, p, NULL, NULL, &err) != SQLITE_OK) {
+			sm_ierror("function cache SQL error: %s", err);
+			sqlite3_free(err);
+			err = NULL;
+		}
+		p += strlen(p) + 1;
+	}
+}
+
+static void replay_inlines(struct capture *capture)
+{
+	char *p = capture->buf[BUF_INLINES];
+	char *end = p + capture->len[BUF_INLINES];
+
+	while (p < end) {
+		__queue_inline_function(p);
+		p += strlen(p) + 1;
+	}
+}
+
+static void replay(struct capture *capture)
+{
+	FILE *fds[BUF_CACHE_DB] = { sm_outfd, sql_outfd, caller_info_fd };
+	int i;
+
+	for (i = 0; i < BUF_CACHE_DB; i++)
+		fwrite(capture->buf[i], 1, capture->len[i], fds[i]);
+	replay_cache_db(capture);
+	replay_inlines(capture);
+	sm_nr_checks += capture->nr_checks;
+	sm_nr_errors += capture->nr_errors;
+}
+
+bool __function_cache_lookup(struct symbol *sym)
+{
+	if (!option_function_cache || option_info)
+		return false;
+
+	if (!get_function_key(sym, &cur_key))
+		return false;
+
+	if (!load_entry(cur_key, &cached)) {
+		misses++;
+		recording = true;
+		return false;
+	}
+
+	if (option_function_cache_verify &&
+	    rand() % 100 < option_function_cache_verify) {
+		verified++;
+		recording = true;
+		verifying = true;
+		return false;
+	}
+
+	hits++;
+	replay(&cached);
+	free_capture(&cached);
+	return true;
+}
+
+void __function_cache_start(void)
+{
+	int i;
+
+	if (!recording)
+		return;
+
+	orig_fd[BUF_OUT] = sm_outfd;
+	orig_fd[BUF_SQL] = sql_outfd;
+	orig_fd[BUF_CALLER_INFO] = caller_info_fd;
+
+	/*
+	 * Normally all three of these are stdout and we have to keep the
+	 * order that things are printed in.
+	 */
+	for (i = 0; i < NUM_BUFS; i++) {
+		capture_fd[i] = NULL;
+		if (i == BUF_SQL && sql_outfd == sm_outfd)
+			continue;
+		if (i == BUF_CALLER_INFO &&
+		    (caller_info_fd == sm_outfd || caller_info_fd == sql_outfd))
+			continue;
+		capture_fd[i] = open_memstream(&fresh.buf[i], &fresh.len[i]);
+		if (!capture_fd[i])
+			sm_fatal("function cache: open_memstream() failed");
+	}
+
+	sm_outfd = capture_fd[BUF_OUT];
+	sql_outfd = capture_fd[BUF_SQL] ?: sm_outfd;
+	if (capture_fd[BUF_CALLER_INFO])
+		caller_info_fd = capture_fd[BUF_CALLER_INFO];
+	else if (orig_fd[BUF_CALLER_INFO] == orig_fd[BUF_SQL])
+		caller_info_fd = sql_outfd;
+	else
+		caller_info_fd = sm_outfd;
+
+	start_checks = sm_nr_checks;
+	start_errors = sm_nr_errors;
+}
+
+void __function_cache_sql(const char *sql)
+{
+	if (!recording)
+		return;
+	fwrite(sql, 1, strlen(sql) + 1, capture_fd[BUF_CACHE_DB]);
+}
+
+void __function_cache_add_inline(struct symbol *sym)
+{
+	struct symbol *tmp;
+
+	if (!recording || !sym->ident)
+		return;
+	FOR_EACH_PTR(recorded_inlines, tmp) {
+		if (tmp == sym)
+			return;
+	} END_FOR_EACH_PTR(tmp);
+	add_ptr_list(&recorded_inlines, sym);
+	fwrite(sym->ident->name, 1, sym->ident->len + 1, capture_fd[BUF_INLINES]);
+}
+
+static void stop_capture(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_BUFS; i++) {
+		if (capture_fd[i])
+			fclose(capture_fd[i]);
+		capture_fd[i] = NULL;
+		if (!fresh.buf[i])
+			fresh.buf[i] = calloc(1, 1);
+	}
+	sm_outfd = orig_fd[BUF_OUT];
+	sql_outfd = orig_fd[BUF_SQL];
+	caller_info_fd = orig_fd[BUF_CALLER_INFO];
+	free_ptr_list(&recorded_inlines);
+
+	fresh.nr_checks = sm_nr_checks - start_checks;
+	fresh.nr_errors = sm_nr_errors - start_errors;
+}
+
+/*
+ * The cache isn't used with --info so there are no mtags in the output and
+ * everything has to be the same, including the cache_db inserts and the
+ * inline functions which were queued.
+ */
+static bool same_capture(struct capture *a, struct capture *b)
+{
+	int i;
+
+	if (a->nr_checks != b->nr_checks ||
+	    a->nr_errors != b->nr_errors)
+		return false;
+	for (i = 0; i < NUM_BUFS; i++) {
+		if (a->len[i] != b->len[i] ||
+		    memcmp(a->buf[i], b->buf[i], a->len[i]) != 0)
+			return false;
+	}
+	return true;
+}
+
+void __function_cache_finish(struct symbol *sym)
+{
+	int i;
+
+	if (!recording)
+		return;
+
+	stop_capture();
+	for (i = 0; i < BUF_CACHE_DB; i++)
+		fwrite(fresh.buf[i], 1, fresh.len[i], orig_fd[i]);
+
+	if (verifying && !same_capture(&fresh, &cached)) {
+		mismatches++;
+		fprintf(stderr, "function cache: %s:%d %s() output changed\n",
+			get_filename(), sym->pos.line,
+			sym->ident ? sym->ident->name : "<anon>");
+	}
+	save_entry(cur_key, &fresh);
+
+	free_capture(&fresh);
+	free_capture(&cached);
+	recording = false;
+	verifying = false;
+}
+
+void __print_function_cache_stats(void)
+{
+	if (!option_function_cache)
+		return;
+	sm_msg("function cache: hits: %d misses: %d verified: %d mismatches: %d",
+	       hits, misses, verified, mismatches);
+}
+
+void __init_function_cache(void)
+{
+	if (!option_function_cache)
+		return;
+	if (mkdir(option_function_cache, 0777) && errno != EEXIST)
+		sm_fatal("Cannot create %s: %s", option_function_cache,
+			 strerror(errno));
+	hash_binary();
+	srand(getpid());
+}
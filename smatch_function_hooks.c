@@ -75,6 +75,7 @@
 
 struct fcall_back {
 	int type;
+	int owner;
 	struct data_range *range;
 	union {
 		func_hook *call_back;
@@ -122,6 +123,7 @@ struct param_data {
 
 struct return_implies_callback {
 	int type;
+	int owner;
 	bool param_key;
 	union {
 		return_implies_hook *callback;
@@ -201,6 +203,7 @@ static struct fcall_back *alloc_fcall_back(int type, void *call_back,
 
 	cb = __alloc_fcall_back(0);
 	cb->type = type;
+	cb->owner = __cur_check_id;
 	cb->u.call_back = call_back;
 	cb->info = info;
 	return cb;
@@ -223,12 +226,105 @@ static struct call_back_list *get_call_backs(const char *fn_name)
 	return search_callback(func_hash, (char *)fn_name);
 }
 
+/*
+ * Most calls are direct calls and the same function is called over and over
+ * so cache the hook lists by ident pointer instead of hashing the name every
+ * time.  Functions without hooks are cached as well, with a NULL list.
+ */
+struct ident_cache_entry {
+	struct ident *ident;
+	struct call_back_list *list;
+};
+static struct ident_cache_entry *ident_cache;
+static unsigned int ident_cache_size;
+static unsigned int ident_cache_used;
+
+static inline unsigned int hash_ident_ptr(struct ident *ident)
+{
+	unsigned long val = (unsigned long)ident;
+
+	val ^= val >> 17;
+	val *= 0x9E3779B97F4A7C15ULL;
+	return val >> 32;
+}
+
+static void clear_ident_cache(void)
+{
+	if (!ident_cache_used)
+		return;
+	memset(ident_cache, 0, ident_cache_size * sizeof(*ident_cache));
+	ident_cache_used = 0;
+}
+
+static void insert_ident_cache(struct ident *ident, struct call_back_list *list)
+{
+	unsigned int i;
+
+	i = hash_ident_ptr(ident) & (ident_cache_size - 1);
+	while (ident_cache[i].ident)
+		i = (i + 1) & (ident_cache_size - 1);
+	ident_cache[i].ident = ident;
+	ident_cache[i].list = list;
+	ident_cache_used++;
+}
+
+static void grow_ident_cache(void)
+{
+	struct ident_cache_entry *old = ident_cache;
+	unsigned int old_size = ident_cache_size;
+	unsigned int i;
+
+	ident_cache_size = old_size ? old_size * 2 : 1024;
+	ident_cache = calloc(ident_cache_size, sizeof(*ident_cache));
+	ident_cache_used = 0;
+	for (i = 0; i < old_size; i++) {
+		if (old[i].ident)
+			insert_ident_cache(old[i].ident, old[i].list);
+	}
+	free(old);
+}
+
+static struct call_back_list *get_ident_call_backs(struct ident *ident)
+{
+	struct call_back_list *list;
+	unsigned int i;
+
+	if (ident_cache_size) {
+		i = hash_ident_ptr(ident) & (ident_cache_size - 1);
+		while (ident_cache[i].ident) {
+			if (ident_cache[i].ident == ident)
+				return ident_cache[i].list;
+			i = (i + 1) & (ident_cache_size - 1);
+		}
+	}
+
+	list = search_callback(func_hash, ident->name);
+	if ((ident_cache_used + 1) * 2 > ident_cache_size)
+		grow_ident_cache();
+	insert_ident_cache(ident, list);
+	return list;
+}
+
+static struct call_back_list *get_call_backs_expr(struct expression *fn)
+{
+	fn = strip_expr(fn);
+	if (fn && fn->type == EXPR_SYMBOL && fn->symbol && fn->symbol->ident)
+		return get_ident_call_backs(fn->symbol->ident);
+	return get_call_backs(get_fn_name(fn));
+}
+
+static void add_call_back(const char *look_for, struct fcall_back *cb)
+{
+	add_callback(func_hash, look_for, cb);
+	clear_ident_cache();
+}
+
 void add_function_hook(const char *look_for, func_hook *call_back, void *info)
 {
 	struct fcall_back *cb;
 
 	cb = alloc_fcall_back(REGULAR_CALL, call_back, info);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 void add_function_hook_early(const char *look_for, func_hook *call_back, void *info)
@@ -236,7 +332,7 @@ void add_function_hook_early(const char *look_for, func_hook *call_back, void *i
 	struct fcall_back *cb;
 
 	cb = alloc_fcall_back(REGULAR_CALL_EARLY, call_back, info);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 void add_function_hook_late(const char *look_for, func_hook *call_back, void *info)
@@ -244,7 +340,7 @@ void add_function_hook_late(const char *look_for, func_hook *call_back, void *in
 	struct fcall_back *cb;
 
 	cb = alloc_fcall_back(REGULAR_CALL_LATE, call_back, info);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 void add_function_assign_hook(const char *look_for, func_hook *call_back,
@@ -253,7 +349,7 @@ void add_function_assign_hook(const char *look_for, func_hook *call_back,
 	struct fcall_back *cb;
 
 	cb = alloc_fcall_back(ASSIGN_CALL, call_back, info);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 static void register_funcs_from_file_helper(const char *file,
@@ -303,7 +399,7 @@ void add_implied_return_hook(const char *look_for,
 	struct fcall_back *cb;
 
 	cb = alloc_fcall_back(IMPLIED_RETURN, call_back, info);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 void add_cull_hook(const char *look_for, cull_hook *call_back, void *info)
@@ -311,7 +407,7 @@ void add_cull_hook(const char *look_for, cull_hook *call_back, void *info)
 	struct fcall_back *cb;
 
 	cb = alloc_fcall_back(CULL_HOOK, call_back, info);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 static void db_helper(struct expression *expr, param_key_hook *call_back, int param, const char *key, void *info)
@@ -482,7 +578,7 @@ void add_macro_assign_hook(const char *look_for, func_hook *call_back,
 	struct fcall_back *cb;
 
 	cb = alloc_fcall_back(MACRO_ASSIGN, call_back, info);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 void add_macro_assign_hook_extra(const char *look_for, func_hook *call_back,
@@ -491,7 +587,7 @@ void add_macro_assign_hook_extra(const char *look_for, func_hook *call_back,
 	struct fcall_back *cb;
 
 	cb = alloc_fcall_back(MACRO_ASSIGN_EXTRA, call_back, info);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 void return_implies_state(const char *look_for, long long start, long long end,
@@ -501,7 +597,7 @@ void return_implies_state(const char *look_for, long long start, long long end,
 
 	cb = alloc_fcall_back(RANGED_CALL, call_back, info);
 	cb->range = alloc_range_perm(ll_to_sval(start), ll_to_sval(end));
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 void return_implies_state_sval(const char *look_for, sval_t start, sval_t end,
@@ -511,7 +607,7 @@ void return_implies_state_sval(const char *look_for, sval_t start, sval_t end,
 
 	cb = alloc_fcall_back(RANGED_CALL, call_back, info);
 	cb->range = alloc_range_perm(start, end);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 void return_implies_exact(const char *look_for, sval_t start, sval_t end,
@@ -521,7 +617,7 @@ void return_implies_exact(const char *look_for, sval_t start, sval_t end,
 
 	cb = alloc_fcall_back(RANGED_EXACT, call_back, info);
 	cb->range = alloc_range_perm(start, end);
-	add_callback(func_hash, look_for, cb);
+	add_call_back(look_for, cb);
 }
 
 static struct return_implies_callback *alloc_db_return_callback(int type, bool param_key, void *callback)
@@ -530,6 +626,7 @@ static struct return_implies_callback *alloc_db_return_callback(int type, bool p
 
 	cb = __alloc_return_implies_callback(0);
 	cb->type = type;
+	cb->owner = __cur_check_id;
 	cb->param_key = param_key;
 	cb->callback = callback;
 
@@ -548,12 +645,14 @@ static void call_db_return_callback(struct db_callback_info *db_info,
 				    struct return_implies_callback *cb,
 				    int param, char *key, char *value)
 {
+	profile_enter(cb->owner, PROF_FUNCTION_HOOK);
 	if (cb->param_key) {
 		db_helper(db_info->expr, cb->pk_callback, param, key, NULL);
 		add_ptr_list(&db_info->called, cb);
 	} else {
 		cb->callback(db_info->expr, param, key, value);
 	}
+	profile_leave();
 }
 
 void select_return_param_key(int type, param_key_hook *callback)
@@ -587,7 +686,9 @@ static bool call_call_backs(struct call_back_list *list, int type,
 
 	FOR_EACH_PTR(list, tmp) {
 		if (tmp->type == type) {
+			profile_enter(tmp->owner, PROF_FUNCTION_HOOK);
 			(tmp->u.call_back)(fn, expr, tmp->info);
+			profile_leave();
 			handled = true;
 		}
 	} END_FOR_EACH_PTR(tmp);
@@ -605,11 +706,11 @@ static void call_function_hooks(struct expression *expr, enum fn_hook_type type)
 	if (expr->type != EXPR_CALL)
 		return;
 
-	fn_name = get_fn_name(expr->fn);
-	call_backs = get_call_backs(fn_name);
+	call_backs = get_call_backs_expr(expr->fn);
 	if (!call_backs)
 		return;
 
+	fn_name = get_fn_name(expr->fn);
 	call_call_backs(call_backs, type, fn_name, expr);
 }
 
@@ -627,7 +728,9 @@ static void call_ranged_call_backs(struct call_back_list *list,
 	struct fcall_back *tmp;
 
 	FOR_EACH_PTR(list, tmp) {
+		profile_enter(tmp->owner, PROF_FUNCTION_HOOK);
 		(tmp->u.ranged)(fn, call_expr, assign_expr, tmp->info);
+		profile_leave();
 	} END_FOR_EACH_PTR(tmp);
 }
 
@@ -745,10 +848,10 @@ static void call_implies_callbacks(int comparison, struct expression *expr, sval
 
 	*implied_true = NULL;
 	*implied_false = NULL;
-	fn_name = get_fn_name(expr->fn);
-	call_backs = get_call_backs(fn_name);
+	call_backs = get_call_backs_expr(expr->fn);
 	if (!call_backs)
 		return;
+	fn_name = get_fn_name(expr->fn);
 	value_range = alloc_range(sval, sval);
 
 	/* set true states */
@@ -759,7 +862,9 @@ static void call_implies_callbacks(int comparison, struct expression *expr, sval
 			continue;
 		if (!true_comparison_range_LR(comparison, tmp->range, value_range, left))
 			continue;
+		profile_enter(tmp->owner, PROF_FUNCTION_HOOK);
 		(tmp->u.ranged)(fn_name, expr, NULL, tmp->info);
+		profile_leave();
 	} END_FOR_EACH_PTR(tmp);
 	tmp_stree = __pop_fake_cur_stree();
 	merge_fake_stree(&true_states, tmp_stree);
@@ -773,7 +878,9 @@ static void call_implies_callbacks(int comparison, struct expression *expr, sval
 			continue;
 		if (!false_comparison_range_LR(comparison, tmp->range, value_range, left))
 			continue;
+		profile_enter(tmp->owner, PROF_FUNCTION_HOOK);
 		(tmp->u.ranged)(fn_name, expr, NULL, tmp->info);
+		profile_leave();
 	} END_FOR_EACH_PTR(tmp);
 	tmp_stree = __pop_fake_cur_stree();
 	merge_fake_stree(&false_states, tmp_stree);
@@ -814,8 +921,10 @@ static void call_cull_hooks(struct db_callback_info *db_info, struct range_list
 	FOR_EACH_PTR(call_backs, tmp) {
 		if (tmp->type != CULL_HOOK)
 			continue;
+		profile_enter(tmp->owner, PROF_FUNCTION_HOOK);
 		if ((tmp->u.cull_hook)(db_info->expr, rl, tmp->info))
 			db_info->cull = 1;
+		profile_leave();
 	} END_FOR_EACH_PTR(tmp);
 }
 
@@ -1456,15 +1565,20 @@ static void call_ranged_return_hooks(struct db_callback_info *db_info)
 	if (expr->type != EXPR_CALL)
 		return;
 
+	call_backs = get_call_backs_expr(expr->fn);
+	if (!call_backs)
+		return;
 	fn_name = get_fn_name(expr->fn);
-	call_backs = get_call_backs(fn_name);
 	FOR_EACH_PTR(call_backs, tmp) {
 		if (tmp->type != RANGED_CALL)
 			continue;
 		range_rl = alloc_rl(tmp->range->min, tmp->range->max);
 		range_rl = cast_rl(estate_type(db_info->ret_state), range_rl);
-		if (possibly_true_rl(range_rl, SPECIAL_EQUAL, estate_rl(db_info->ret_state)))
+		if (possibly_true_rl(range_rl, SPECIAL_EQUAL, estate_rl(db_info->ret_state))) {
+			profile_enter(tmp->owner, PROF_FUNCTION_HOOK);
 			(tmp->u.ranged)(fn_name, expr, db_info->expr, tmp->info);
+			profile_leave();
+		}
 	} END_FOR_EACH_PTR(tmp);
 
 	FOR_EACH_PTR(call_backs, tmp) {
@@ -1485,7 +1599,9 @@ static void call_ranged_return_hooks(struct db_callback_info *db_info)
 		if (remove_range(estate_rl(db_info->ret_state),
 				 rl_min(range_rl), rl_max(range_rl)))
 			continue;
+		profile_enter(tmp->owner, PROF_FUNCTION_HOOK);
 		(tmp->u.ranged)(fn_name, expr, db_info->expr, tmp->info);
+		profile_leave();
 	} END_FOR_EACH_PTR(tmp);
 }
 
@@ -1642,7 +1758,7 @@ static void match_assign_call(struct expression *expr)
 		return;
 
 	fn_name = get_fn_name(right->fn);
-	call_backs = get_call_backs(fn_name);
+	call_backs = get_call_backs_expr(right->fn);
 
 	/*
 	 * The ordering here is sort of important.
@@ -1830,22 +1946,31 @@ static void match_macro_assign(struct expression *expr)
 bool get_implied_return(struct expression *expr, struct range_list **rl)
 {
 	struct call_back_list *call_backs;
+	struct expression *fn_expr;
 	struct fcall_back *tmp;
 	bool handled = false;
-	char *fn;
+	char *fn = NULL;
 
 	*rl = NULL;
 
 	expr = strip_expr(expr);
-	fn = expr_to_var(expr->fn);
-	if (!fn)
-		goto out;
-
-	call_backs = search_callback(func_hash, fn);
+	fn_expr = strip_expr(expr->fn);
+	if (fn_expr->type == EXPR_SYMBOL && fn_expr->symbol &&
+	    fn_expr->symbol->ident) {
+		call_backs = get_ident_call_backs(fn_expr->symbol->ident);
+	} else {
+		fn = expr_to_var(expr->fn);
+		if (!fn)
+			goto out;
+		call_backs = search_callback(func_hash, fn);
+	}
 
 	FOR_EACH_PTR(call_backs, tmp) {
-		if (tmp->type == IMPLIED_RETURN)
-			handled |= (tmp->u.implied_return)(expr, tmp->info, rl);
+		if (tmp->type != IMPLIED_RETURN)
+			continue;
+		profile_enter(tmp->owner, PROF_FUNCTION_HOOK);
+		handled |= (tmp->u.implied_return)(expr, tmp->info, rl);
+		profile_leave();
 	} END_FOR_EACH_PTR(tmp);
 
 out:
@@ -1302,17 +1302,6 @@ struct expression *get_last_expr_from_expression_stmt(struct expression *expr)
 	return NULL;
 }
 
-int ms_since(struct timeval *start)
-{
-	struct timeval end;
-	double diff;
-
-	gettimeofday(&end, NULL);
-	diff = (end.tv_sec - start->tv_sec) * 1000.0;
-	diff += (end.tv_usec - start->tv_usec) / 1000.0;
-	return (int)diff;
-}
-
 int parent_is_gone_var_sym(const char *name, struct symbol *sym)
 {
 	if (!name || !sym)
@@ -35,11 +35,40 @@ DECLARE_PTR_LIST(hook_func_list, struct hook_container);
 
 typedef void (sym_list_func)(struct symbol_list *sym_list);
 typedef void (array_init_hook)(struct expression *array, int nr);
+typedef void (case_func)(struct expression *switch_expr,
+			 struct range_list *rl);
+
+struct case_data {
+	struct expression *switch_expr;
+	struct range_list *rl;
+};
+
+/*
+ * The hooks are registered as a list of hook_containers but once the
+ * registration is done they are copied into a flat array for each hook type
+ * so calling them is just a loop over function pointers.
+ */
+struct hook_table {
+	union {
+		void **fns;
+		expr_func **expr_fns;
+		stmt_func **stmt_fns;
+		sym_func **sym_fns;
+		sym_list_func **sym_list_fns;
+		case_func **case_fns;
+	};
+};
 
-static struct hook_func_list *merge_funcs;
-static struct hook_func_list *unmatched_state_funcs;
 static struct hook_func_list *array_init_hooks;
 static struct hook_func_list *hook_array[NUM_HOOKS] = {};
+static struct hook_table hook_tables[NUM_HOOKS];
+static bool hook_tables_built;
+int __nr_hooks[NUM_HOOKS];
+static unsigned long long dispatch_cnt[NUM_HOOKS];
+
+static merge_func_t **merge_funcs;
+static unmatched_func_t **unmatched_state_funcs;
+
 static const enum data_type data_types[NUM_HOOKS] = {
 	[EXPR_HOOK] = EXPR_PTR,
 	[EXPR_HOOK_AFTER] = EXPR_PTR,
@@ -84,6 +113,50 @@ static const enum data_type data_types[NUM_HOOKS] = {
 	[END_FILE_HOOK] = SYM_LIST_PTR,
 };
 
+static const char *hook_names[NUM_HOOKS] = {
+	[EXPR_HOOK] = "EXPR_HOOK",
+	[EXPR_HOOK_AFTER] = "EXPR_HOOK_AFTER",
+	[STMT_HOOK] = "STMT_HOOK",
+	[STMT_HOOK_AFTER] = "STMT_HOOK_AFTER",
+	[SYM_HOOK] = "SYM_HOOK",
+	[STRING_HOOK] = "STRING_HOOK",
+	[DECLARATION_HOOK] = "DECLARATION_HOOK",
+	[DECLARATION_HOOK_AFTER] = "DECLARATION_HOOK_AFTER",
+	[ASSIGNMENT_HOOK] = "ASSIGNMENT_HOOK",
+	[ASSIGNMENT_HOOK_AFTER] = "ASSIGNMENT_HOOK_AFTER",
+	[RAW_ASSIGNMENT_HOOK] = "RAW_ASSIGNMENT_HOOK",
+	[GLOBAL_ASSIGNMENT_HOOK] = "GLOBAL_ASSIGNMENT_HOOK",
+	[CALL_ASSIGNMENT_HOOK] = "CALL_ASSIGNMENT_HOOK",
+	[MACRO_ASSIGNMENT_HOOK] = "MACRO_ASSIGNMENT_HOOK",
+	[BINOP_HOOK] = "BINOP_HOOK",
+	[OP_HOOK] = "OP_HOOK",
+	[LOGIC_HOOK] = "LOGIC_HOOK",
+	[PRELOOP_HOOK] = "PRELOOP_HOOK",
+	[POSTLOOP_HOOK] = "POSTLOOP_HOOK",
+	[AFTER_LOOP_NO_BREAKS] = "AFTER_LOOP_NO_BREAKS",
+	[CONDITION_HOOK] = "CONDITION_HOOK",
+	[SELECT_HOOK] = "SELECT_HOOK",
+	[WHOLE_CONDITION_HOOK] = "WHOLE_CONDITION_HOOK",
+	[FUNCTION_CALL_HOOK_BEFORE] = "FUNCTION_CALL_HOOK_BEFORE",
+	[FUNCTION_CALL_HOOK] = "FUNCTION_CALL_HOOK",
+	[CALL_HOOK_AFTER_INLINE] = "CALL_HOOK_AFTER_INLINE",
+	[FUNCTION_CALL_HOOK_AFTER_DB] = "FUNCTION_CALL_HOOK_AFTER_DB",
+	[DEREF_HOOK] = "DEREF_HOOK",
+	[CASE_HOOK] = "CASE_HOOK",
+	[ASM_HOOK] = "ASM_HOOK",
+	[CAST_HOOK] = "CAST_HOOK",
+	[SIZEOF_HOOK] = "SIZEOF_HOOK",
+	[BASE_HOOK] = "BASE_HOOK",
+	[FUNC_DEF_HOOK] = "FUNC_DEF_HOOK",
+	[AFTER_DEF_HOOK] = "AFTER_DEF_HOOK",
+	[END_FUNC_HOOK] = "END_FUNC_HOOK",
+	[AFTER_FUNC_HOOK] = "AFTER_FUNC_HOOK",
+	[RETURN_HOOK] = "RETURN_HOOK",
+	[INLINE_FN_START] = "INLINE_FN_START",
+	[INLINE_FN_END] = "INLINE_FN_END",
+	[END_FILE_HOOK] = "END_FILE_HOOK",
+};
+
 void (**pre_merge_hooks)(struct sm_state *cur, struct sm_state *other);
 
 struct scope_container {
@@ -96,7 +169,24 @@ DECLARE_PTR_LIST(scope_hook_stack, struct scope_hook_list);
 static struct scope_hook_stack *scope_hooks;
 int my_id;
 
-extern int __cur_check_id;
+
+static void build_hook_table(enum hook_type type)
+{
+	struct hook_table *table = &hook_tables[type];
+	struct hook_container *container;
+	int i = 0;
+
+	free(table->fns);
+
+	__nr_hooks[type] = ptr_list_size((struct ptr_list *)hook_array[type]);
+	table->fns = malloc(__nr_hooks[type] * sizeof(*table->fns));
+
+	FOR_EACH_PTR(hook_array[type], container) {
+		table->fns[i] = container->fn;
+		i++;
+	} END_FOR_EACH_PTR(container);
+}
+
 void add_hook(void *func, enum hook_type type)
 {
 	struct hook_container *container = __alloc_hook_container(0);
@@ -106,97 +196,166 @@ void add_hook(void *func, enum hook_type type)
 	container->fn = func;
 
 	add_ptr_list(&hook_array[type], container);
+
+	if (hook_tables_built)
+		build_hook_table(type);
 }
 
-void add_merge_hook(int client_id, merge_func_t *func)
+void __build_hook_tables(void)
 {
-	struct hook_container *container = __alloc_hook_container(0);
-	container->owner = client_id;
-	container->fn = func;
-	add_ptr_list(&merge_funcs, container);
+	int type;
+
+	for (type = 0; type < NUM_HOOKS; type++)
+		build_hook_table(type);
+	hook_tables_built = true;
 }
 
-void add_unmatched_state_hook(int client_id, unmatched_func_t *func)
+int __hooks_owned_by(int owner)
 {
-	struct hook_container *container = __alloc_hook_container(0);
-	container->owner = client_id;
-	container->fn = func;
-	add_ptr_list(&unmatched_state_funcs, container);
+	struct hook_container *container;
+	int type, cnt = 0;
+
+	for (type = 0; type < NUM_HOOKS; type++) {
+		FOR_EACH_PTR(hook_array[type], container) {
+			if (container->owner == owner)
+				cnt++;
+		} END_FOR_EACH_PTR(container);
+	}
+	return cnt;
 }
 
-void add_pre_merge_hook(int client_id, void (*hook)(struct sm_state *cur, struct sm_state *other))
+void add_merge_hook(int client_id, merge_func_t *func)
 {
-	pre_merge_hooks[client_id] = hook;
+	/* the first merge hook wins */
+	if (!merge_funcs[client_id])
+		merge_funcs[client_id] = func;
 }
 
-static void pass_expr_to_client(void *fn, void *data)
+void add_unmatched_state_hook(int client_id, unmatched_func_t *func)
 {
-	((expr_func *)fn)((struct expression *)data);
+	if (!unmatched_state_funcs[client_id])
+		unmatched_state_funcs[client_id] = func;
 }
 
-static void pass_stmt_to_client(void *fn, void *data)
+void add_pre_merge_hook(int client_id, void (*hook)(struct sm_state *cur, struct sm_state *other))
 {
-	((stmt_func *)fn)((struct statement *)data);
+	pre_merge_hooks[client_id] = hook;
 }
 
-static void pass_sym_to_client(void *fn, void *data)
+static void call_one_hook(void *fn, void *data, enum hook_type type)
 {
-	((sym_func *)fn)((struct symbol *)data);
+	struct case_data *cd;
+
+	switch (data_types[type]) {
+	case EXPR_PTR:
+		((expr_func *)fn)((struct expression *)data);
+		break;
+	case STMT_PTR:
+		((stmt_func *)fn)((struct statement *)data);
+		break;
+	case SYMBOL_PTR:
+		((sym_func *)fn)((struct symbol *)data);
+		break;
+	case SYM_LIST_PTR:
+		((sym_list_func *)fn)((struct symbol_list *)data);
+		break;
+	case NO_DATA:
+		cd = data;
+		((case_func *)fn)(cd->switch_expr, cd->rl);
+		break;
+	}
 }
 
-static void pass_sym_list_to_client(void *fn, void *data)
+/* This is the slow path for --profile-checks */
+static void call_hooks_profiled(void *data, enum hook_type type)
 {
-	((sym_list_func *)fn)((struct symbol_list *)data);
+	struct hook_container *container;
+
+	FOR_EACH_PTR(hook_array[type], container) {
+		profile_enter(container->owner, PROF_HOOK);
+		call_one_hook(container->fn, data, type);
+		profile_leave();
+	} END_FOR_EACH_PTR(container);
 }
 
-void __pass_to_client(void *data, enum hook_type type)
+void __call_hooks(void *data, enum hook_type type)
 {
-	struct hook_container *container;
+	struct hook_table *table = &hook_tables[type];
+	int cnt = __nr_hooks[type];
+	int i;
 
 	if (__debug_skip)
 		return;
 
-	FOR_EACH_PTR(hook_array[type], container) {
-		switch (data_types[type]) {
-		case EXPR_PTR:
-			pass_expr_to_client(container->fn, data);
-			break;
-		case STMT_PTR:
-			pass_stmt_to_client(container->fn, data);
-			break;
-		case SYMBOL_PTR:
-			pass_sym_to_client(container->fn, data);
-			break;
-		case SYM_LIST_PTR:
-			pass_sym_list_to_client(container->fn, data);
-			break;
-		default:
-			sm_warning("internal error. Unhandled hook type: %d", type);
-		}
-	} END_FOR_EACH_PTR(container);
+	dispatch_cnt[type]++;
+
+	if (option_profile_checks) {
+		call_hooks_profiled(data, type);
+		return;
+	}
+
+	switch (data_types[type]) {
+	case EXPR_PTR:
+		for (i = 0; i < cnt; i++)
+			table->expr_fns[i]((struct expression *)data);
+		break;
+	case STMT_PTR:
+		for (i = 0; i < cnt; i++)
+			table->stmt_fns[i]((struct statement *)data);
+		break;
+	case SYMBOL_PTR:
+		for (i = 0; i < cnt; i++)
+			table->sym_fns[i]((struct symbol *)data);
+		break;
+	case SYM_LIST_PTR:
+		for (i = 0; i < cnt; i++)
+			table->sym_list_fns[i]((struct symbol_list *)data);
+		break;
+	default:
+		sm_warning("internal error. Unhandled hook type: %d", type);
+	}
 }
 
 void __pass_case_to_client(struct expression *switch_expr,
 			   struct range_list *rl)
 {
-	typedef void (case_func)(struct expression *switch_expr,
-				 struct range_list *rl);
-	struct hook_container *container;
+	struct hook_table *table = &hook_tables[CASE_HOOK];
+	int i;
 
-	FOR_EACH_PTR(hook_array[CASE_HOOK], container) {
-		((case_func *)container->fn)(switch_expr, rl);
-	} END_FOR_EACH_PTR(container);
+	dispatch_cnt[CASE_HOOK]++;
+
+	if (option_profile_checks) {
+		struct case_data cd = {
+			.switch_expr = switch_expr,
+			.rl = rl,
+		};
+
+		call_hooks_profiled(&cd, CASE_HOOK);
+		return;
+	}
+
+	for (i = 0; i < __nr_hooks[CASE_HOOK]; i++)
+		table->case_fns[i](switch_expr, rl);
 }
 
-int __has_merge_function(int client_id)
+void __print_hook_stats(void)
 {
-	struct hook_container *tmp;
+	int type;
+
+	for (type = 0; type < NUM_HOOKS; type++) {
+		if (!dispatch_cnt[type])
+			continue;
+		sm_msg("hook stats: %-27s hooks: %3d dispatches: %10llu calls: %12llu",
+		       hook_names[type], __nr_hooks[type], dispatch_cnt[type],
+		       dispatch_cnt[type] * __nr_hooks[type]);
+	}
+}
 
-	FOR_EACH_PTR(merge_funcs, tmp) {
-		if (tmp->owner == client_id)
-			return 1;
-	} END_FOR_EACH_PTR(tmp);
-	return 0;
+int __has_merge_function(int client_id)
+{
+	if (client_id >= num_checks)
+		return 0;
+	return !!merge_funcs[client_id];
 }
 
 struct smatch_state *__client_merge_function(int owner,
@@ -204,7 +363,6 @@ struct smatch_state *__client_merge_function(int owner,
 					     struct smatch_state *s2)
 {
 	struct smatch_state *tmp_state;
-	struct hook_container *tmp;
 
 	/* Pass NULL states first and the rest alphabetically by name */
 	if (!s2 || (s1 && strcmp(s2->name, s1->name) < 0)) {
@@ -213,21 +371,25 @@ struct smatch_state *__client_merge_function(int owner,
 		s2 = tmp_state;
 	}
 
-	FOR_EACH_PTR(merge_funcs, tmp) {
-		if (tmp->owner == owner)
-			return ((merge_func_t *)tmp->fn)(s1, s2);
-	} END_FOR_EACH_PTR(tmp);
+	if (owner < num_checks && merge_funcs[owner]) {
+		profile_enter(owner, PROF_MERGE);
+		tmp_state = merge_funcs[owner](s1, s2);
+		profile_leave();
+		return tmp_state;
+	}
 	return &undefined;
 }
 
 struct smatch_state *__client_unmatched_state_function(struct sm_state *sm)
 {
-	struct hook_container *tmp;
+	struct smatch_state *state;
 
-	FOR_EACH_PTR(unmatched_state_funcs, tmp) {
-		if (tmp->owner == sm->owner)
-			return ((unmatched_func_t *)tmp->fn)(sm);
-	} END_FOR_EACH_PTR(tmp);
+	if (sm->owner < num_checks && unmatched_state_funcs[sm->owner]) {
+		profile_enter(sm->owner, PROF_MERGE);
+		state = unmatched_state_funcs[sm->owner](sm);
+		profile_leave();
+		return state;
+	}
 	return &undefined;
 }
 
@@ -236,8 +398,11 @@ void call_pre_merge_hook(struct sm_state *cur, struct sm_state *other)
 	if (cur->owner >= num_checks)
 		return;
 
-	if (pre_merge_hooks[cur->owner])
+	if (pre_merge_hooks[cur->owner]) {
+		profile_enter(cur->owner, PROF_MERGE);
 		pre_merge_hooks[cur->owner](cur, other);
+		profile_leave();
+	}
 }
 
 static struct scope_hook_list *pop_scope_hook_list(struct scope_hook_stack **stack)
@@ -329,6 +494,8 @@ void allocate_hook_memory(void)
 {
 	pre_merge_hooks = malloc(num_checks * sizeof(*pre_merge_hooks));
 	memset(pre_merge_hooks, 0, num_checks * sizeof(*pre_merge_hooks));
+	merge_funcs = calloc(num_checks, sizeof(*merge_funcs));
+	unmatched_state_funcs = calloc(num_checks, sizeof(*unmatched_state_funcs));
 }
 
 void register_hooks(int id)
@@ -462,13 +462,14 @@ static int going_too_slow(void)
 		return 1;
 	}
 
-	if (time_parsing_function() < 60) {
+	if (!budget_exceeded(BUDGET_NO_IMPLICATIONS)) {
 		implications_off = false;
 		return 0;
 	}
 
 	if (!__inline_fn && printed != cur_func_sym) {
-		sm_perror("turning off implications after 60 seconds");
+		sm_perror("turning off implications after %d seconds",
+			  budget_limit(BUDGET_NO_IMPLICATIONS));
 		printed = cur_func_sym;
 	}
 	implications_off = true;
@@ -1015,7 +1016,7 @@ void param_limit_implications(struct expression *expr, int param, char *key, cha
 	struct symbol *left_sym = NULL;
 	int mixed = 0;
 
-	if (time_parsing_function() > 40)
+	if (budget_exceeded(BUDGET_NO_PARAM_IMPLICATIONS))
 		return;
 
 	orig_expr = expr;
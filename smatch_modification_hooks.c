@@ -37,6 +37,13 @@
 static sm_hook **hooks;
 static sm_hook **hooks_late;
 
+/*
+ * The owners which have registered a modification hook, sorted by owner.  Only
+ * these owners have to be searched when something is modified.
+ */
+static int *hooked_owners;
+static int num_hooked_owners;
+
 ALLOCATOR(modification_data, "modification data");
 
 static int my_id;
@@ -63,11 +70,28 @@ static struct smatch_state *alloc_my_state(struct expression *expr, struct smatc
 	return state;
 }
 
+static void add_hooked_owner(int owner)
+{
+	int i;
+
+	for (i = 0; i < num_hooked_owners; i++) {
+		if (hooked_owners[i] == owner)
+			return;
+		if (hooked_owners[i] > owner)
+			break;
+	}
+	memmove(&hooked_owners[i + 1], &hooked_owners[i],
+		(num_hooked_owners - i) * sizeof(*hooked_owners));
+	hooked_owners[i] = owner;
+	num_hooked_owners++;
+}
+
 void add_modification_hook(int owner, sm_hook *call_back)
 {
 	if (hooks[owner])
 		sm_fatal("multiple modification hooks for %s", check_name(owner));
 	hooks[owner] = call_back;
+	add_hooked_owner(owner);
 }
 
 void add_modification_hook_late(int owner, sm_hook *call_back)
@@ -75,6 +99,7 @@ void add_modification_hook_late(int owner, sm_hook *call_back)
 	if (hooks_late[owner])
 		sm_fatal("multiple late modification hooks for %s", check_name(owner));
 	hooks_late[owner] = call_back;
+	add_hooked_owner(owner);
 }
 
 static int shared_cnt(const char *one, const char *two)
@@ -116,26 +141,74 @@ bool is_sub_member(const char *name, struct symbol *sym, struct sm_state *sm)
 	return false;
 }
 
+static void add_sub_members_prefix(struct stree *stree, int owner, const char *prefix,
+				   const char *name, struct symbol *sym,
+				   struct state_list **slist)
+{
+	AvlIter iter;
+	int len = strlen(prefix);
+
+	for (avl_iter_begin_name(&iter, stree, owner, prefix);
+	     iter.node != NULL;
+	     avl_iter_next(&iter)) {
+		if (iter.sm->owner != owner)
+			break;
+		if (strncmp(iter.sm->name, prefix, len) != 0)
+			break;
+		if (is_sub_member(name, sym, iter.sm))
+			add_ptr_list(slist, iter.sm);
+	}
+}
+
+/*
+ * The sub members of "name" are "name", "name->foo", "name.foo" and the same
+ * with a '&' in front.  The stree is sorted by owner and name so instead of
+ * looking at every state we only look at the states which start with those
+ * two prefixes.
+ */
+static void add_sub_members(struct stree *stree, int owner, const char *name,
+			    const char *amp_name, struct symbol *sym,
+			    struct state_list **slist)
+{
+	if (strcmp(amp_name, name) < 0) {
+		add_sub_members_prefix(stree, owner, amp_name, name, sym, slist);
+		add_sub_members_prefix(stree, owner, name, name, sym, slist);
+	} else {
+		add_sub_members_prefix(stree, owner, name, name, sym, slist);
+		add_sub_members_prefix(stree, owner, amp_name, name, sym, slist);
+	}
+}
+
 static void call_modification_hooks_name_sym(char *name, struct symbol *sym, struct expression *mod_expr, int late)
 {
+	struct state_list *slist = NULL;
+	struct stree *stree;
 	struct sm_state *sm;
 	struct smatch_state *prev;
-	int match;
+	char buf[256];
+	char *amp_name = buf;
+	int owner;
+	int i;
 
 	prev = get_state(my_id, name, sym);
 
 	if (cur_func_sym && !__in_fake_assign)
 		set_state(my_id, name, sym, alloc_my_state(mod_expr, prev));
 
-	FOR_EACH_SM_SAFE(__get_cur_stree(), sm) {
-		if (sm->owner > num_checks)
-			continue;
-		if (!hooks[sm->owner] && !hooks_late[sm->owner])
-			continue;
-		match = is_sub_member(name, sym, sm);
-		if (!match)
+	if (strlen(name) + 2 > sizeof(buf))
+		amp_name = malloc(strlen(name) + 2);
+	sprintf(amp_name, "&%s", name);
+
+	stree = __get_cur_stree();
+	for (i = 0; i < num_hooked_owners; i++) {
+		owner = hooked_owners[i];
+		if (!has_states(stree, owner))
 			continue;
+		add_sub_members(stree, owner, name, amp_name, sym, &slist);
+	}
 
+	FOR_EACH_PTR(slist, sm) {
+		profile_enter(sm->owner, PROF_MODIFICATION);
 		if (late == EARLY || late == EARLY_LATE) {
 			if (hooks[sm->owner])
 				(hooks[sm->owner])(sm, mod_expr);
@@ -144,7 +217,12 @@ static void call_modification_hooks_name_sym(char *name, struct symbol *sym, str
 			if (hooks_late[sm->owner])
 				(hooks_late[sm->owner])(sm, mod_expr);
 		}
-	} END_FOR_EACH_SM_SAFE(sm);
+		profile_leave();
+	} END_FOR_EACH_PTR(sm);
+	free_slist(&slist);
+
+	if (amp_name != buf)
+		free(amp_name);
 }
 
 static void call_modification_hooks(struct expression *expr, struct expression *mod_expr, int late)
@@ -284,6 +362,7 @@ void allocate_modification_hooks(void)
 	memset(hooks, 0, num_checks * sizeof(*hooks));
 	hooks_late = malloc(num_checks * sizeof(*hooks));
 	memset(hooks_late, 0, num_checks * sizeof(*hooks));
+	hooked_owners = calloc(num_checks, sizeof(*hooked_owners));
 }
 
 void register_modification_hooks(int id)
@@ -30,15 +30,7 @@ static void get_state_hook(int owner, const char *name, struct symbol *sym)
 	static const char *prev;
 	int arg;
 
-	if (!option_info)
-		return;
-
-	if (__ignore_param_used ||
-	    __in_fake_assign ||
-	    __in_fake_parameter_assign ||
-	    __in_function_def ||
-	    __in_unmatched_hook ||
-	    __in_fake_struct_assign)
+	if (__ignore_param_used)
 		return;
 
 	if (!name || name[0] == '&')
@@ -125,7 +117,8 @@ void register_param_used(int id)
 	add_hook(&match_function_def, AFTER_FUNC_HOOK);
 	add_function_data((unsigned long *)&used_stree);
 
-	add_get_state_hook(&get_state_hook);
+	if (option_info)
+		add_get_state_hook(-1, &get_state_hook);
 
 	select_return_implies_hook(PARAM_USED, &set_param_used);
 	all_return_states_hook(&process_states);
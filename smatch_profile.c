@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2026 Oracle.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see http://www.gnu.org/copyleft/gpl.txt
+ */
+
+/*
+ * This is for --profile-checks.  Every place where we call into a check
+ * (the regular hooks, merge functions, modification hooks, function hooks
+ * and the DB callbacks) is wrapped in profile_enter()/profile_leave().  The
+ * time is "self" time, so if a function hook calls __split_expr() then the
+ * hooks which are called from there are charged to their own owners.
+ *
+ * When the option is off then profile_enter() and profile_leave() are just a
+ * test of option_profile_checks.
+ */
+
+#include <time.h>
+#include "smatch.h"
+
+int option_profile_checks;
+char *option_profile_file;
+
+static const char *kind_names[NUM_PROFILE_KINDS] = {
+	[PROF_HOOK] = "hooks",
+	[PROF_MERGE] = "merge",
+	[PROF_MODIFICATION] = "modification",
+	[PROF_FUNCTION_HOOK] = "function_hooks",
+	[PROF_DB] = "db",
+};
+
+struct profile_counts {
+	unsigned long long ns[NUM_PROFILE_KINDS];
+	unsigned long long calls[NUM_PROFILE_KINDS];
+};
+
+static struct profile_counts *counts;
+
+struct profile_frame {
+	int owner;
+	int kind;
+};
+
+#define MAX_PROFILE_DEPTH 1024
+static struct profile_frame stack[MAX_PROFILE_DEPTH];
+static int depth;
+static unsigned long long last_ns;
+static unsigned long long start_ns;
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void charge_top(unsigned long long now)
+{
+	struct profile_frame *frame;
+
+	if (depth == 0 || depth > MAX_PROFILE_DEPTH)
+		return;
+	frame = &stack[depth - 1];
+	counts[frame->owner].ns[frame->kind] += now - last_ns;
+}
+
+void __profile_enter(int owner, enum profile_kind kind)
+{
+	unsigned long long now = now_ns();
+
+	if (owner < 0 || owner >= num_checks)
+		owner = 0;
+
+	charge_top(now);
+	last_ns = now;
+
+	if (depth < MAX_PROFILE_DEPTH) {
+		stack[depth].owner = owner;
+		stack[depth].kind = kind;
+	}
+	depth++;
+	counts[owner].calls[kind]++;
+}
+
+void __profile_leave(void)
+{
+	unsigned long long now = now_ns();
+
+	if (depth == 0)
+		return;
+	charge_top(now);
+	last_ns = now;
+	depth--;
+}
+
+static unsigned long long owner_ns(int owner)
+{
+	unsigned long long total = 0;
+	int kind;
+
+	for (kind = 0; kind < NUM_PROFILE_KINDS; kind++)
+		total += counts[owner].ns[kind];
+	return total;
+}
+
+static unsigned long long owner_calls(int owner)
+{
+	unsigned long long total = 0;
+	int kind;
+
+	for (kind = 0; kind < NUM_PROFILE_KINDS; kind++)
+		total += counts[owner].calls[kind];
+	return total;
+}
+
+static int cmp_owner_time(const void *_a, const void *_b)
+{
+	unsigned long long a = owner_ns(*(const int *)_a);
+	unsigned long long b = owner_ns(*(const int *)_b);
+
+	if (a > b)
+		return -1;
+	if (a < b)
+		return 1;
+	return 0;
+}
+
+static void print_text_report(int *owners, int cnt, unsigned long long total)
+{
+	unsigned long long ns, checks = 0;
+	int i, kind, owner;
+
+	for (i = 0; i < cnt; i++)
+		checks += owner_ns(owners[i]);
+
+	fprintf(stderr, "profile: total %.3fs, in checks %.3fs (%.1f%%)\n",
+		total / 1e9, checks / 1e9, total ? checks * 100.0 / total : 0.0);
+	for (i = 0; i < cnt; i++) {
+		owner = owners[i];
+		ns = owner_ns(owner);
+		fprintf(stderr, "profile: %-45s %10.3fms %5.1f%% %12llu calls",
+			check_name(owner), ns / 1e6,
+			total ? ns * 100.0 / total : 0.0, owner_calls(owner));
+		for (kind = 0; kind < NUM_PROFILE_KINDS; kind++) {
+			if (!counts[owner].calls[kind])
+				continue;
+			fprintf(stderr, " %s=%.3fms/%llu", kind_names[kind],
+				counts[owner].ns[kind] / 1e6,
+				counts[owner].calls[kind]);
+		}
+		fprintf(stderr, "\n");
+	}
+}
+
+static void print_json_report(int *owners, int cnt, unsigned long long total)
+{
+	FILE *fp;
+	int i, kind, owner;
+
+	fp = fopen(option_profile_file, "w");
+	if (!fp)
+		sm_fatal("Cannot open %s", option_profile_file);
+
+	fprintf(fp, "{\n\t\"total_ns\": %llu,\n\t\"checks\": [\n", total);
+	for (i = 0; i < cnt; i++) {
+		owner = owners[i];
+		fprintf(fp, "\t\t{\"name\": \"%s\", \"ns\": %llu, \"calls\": %llu",
+			check_name(owner), owner_ns(owner), owner_calls(owner));
+		for (kind = 0; kind < NUM_PROFILE_KINDS; kind++) {
+			fprintf(fp, ", \"%s\": {\"ns\": %llu, \"calls\": %llu}",
+				kind_names[kind], counts[owner].ns[kind],
+				counts[owner].calls[kind]);
+		}
+		fprintf(fp, "}%s\n", i + 1 < cnt ? "," : "");
+	}
+	fprintf(fp, "\t]\n}\n");
+	fclose(fp);
+}
+
+void __print_profile_report(void)
+{
+	unsigned long long total;
+	int *owners;
+	int cnt = 0;
+	int i;
+
+	if (!option_profile_checks)
+		return;
+
+	total = now_ns() - start_ns;
+
+	owners = malloc(num_checks * sizeof(*owners));
+	for (i = 0; i < num_checks; i++) {
+		if (owner_calls(i))
+			owners[cnt++] = i;
+	}
+	qsort(owners, cnt, sizeof(*owners), cmp_owner_time);
+
+	if (option_profile_file)
+		print_json_report(owners, cnt, total);
+	else
+		print_text_report(owners, cnt, total);
+
+	free(owners);
+}
+
+void __init_profiler(void)
+{
+	if (!option_profile_checks)
+		return;
+	counts = calloc(num_checks, sizeof(*counts));
+	start_ns = now_ns();
+}
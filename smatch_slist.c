@@ -47,7 +47,7 @@ const char *show_sm(struct sm_state *sm)
 	if (pos > sizeof(buf))
 		goto truncate;
 
-	if (ptr_list_size((struct ptr_list *)sm->possible) == 1)
+	if (ptr_list_counted_size((struct ptr_list *)sm->possible) == 1)
 		return alloc_sname(buf);
 
 	pos += snprintf(buf + pos, sizeof(buf) - pos, " (");
@@ -256,7 +256,7 @@ static struct sm_state *alloc_state_no_name(int owner, const char *name,
 
 int too_many_possible(struct sm_state *sm)
 {
-	if (ptr_list_size((struct ptr_list *)sm->possible) >= 100)
+	if (ptr_list_counted_size((struct ptr_list *)sm->possible) >= 100)
 		return 1;
 	return 0;
 }
@@ -296,8 +296,8 @@ static void copy_possibles(struct sm_state *to, struct sm_state *one, struct sm_
 	 *
 	 */
 
-	if (ptr_list_size((struct ptr_list *)two->possible) >
-	    ptr_list_size((struct ptr_list *)one->possible)) {
+	if (ptr_list_counted_size((struct ptr_list *)two->possible) >
+	    ptr_list_counted_size((struct ptr_list *)one->possible)) {
 		large = two;
 		small = one;
 	}
@@ -328,11 +328,11 @@ int out_of_memory(void)
 		return 1;
 
 	/*
-	 * I decided to use 50M here based on trial and error.
-	 * It works out OK for the kernel and so it should work
-	 * for most other projects as well.
+	 * I decided to use 100M of sm_states here based on trial and error.
+	 * It works out OK for the kernel and so it should work for most
+	 * other projects as well.  It can be changed with --budget=oom=<MB>.
 	 */
-	if (sm_state_counter * sizeof(struct sm_state) >= 100000000)
+	if (budget_out_of_memory())
 		return 1;
 
 	/*
@@ -358,9 +358,7 @@ int out_of_memory(void)
 
 int low_on_memory(void)
 {
-	if (sm_state_counter * sizeof(struct sm_state) >= 25000000)
-		return 1;
-	return 0;
+	return budget_low_on_memory();
 }
 
 static void free_sm_state(struct sm_state *sm)
@@ -415,7 +413,7 @@ void free_every_single_sm_state(void)
 
 unsigned long get_pool_count(void)
 {
-	return ptr_list_size((struct ptr_list *)all_pools);
+	return ptr_list_counted_size((struct ptr_list *)all_pools);
 }
 
 struct sm_state *clone_sm(struct sm_state *s)
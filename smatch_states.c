@@ -115,6 +115,11 @@ void __set_cur_stree_writable(void)
 DECLARE_PTR_LIST(check_tracker_list, check_tracker_hook *);
 static struct check_tracker_list **tracker_hooks;
 
+typedef void (get_state_hook)(int owner, const char *name, struct symbol *sym);
+DECLARE_PTR_LIST(get_state_hook_list, get_state_hook *);
+static struct get_state_hook_list **get_state_hooks;
+static bool has_get_state_hooks;
+
 void add_check_tracker(const char *check_name, check_tracker_hook *fn)
 {
 	check_tracker_hook **p;
@@ -152,6 +157,9 @@ void allocate_tracker_array(int num_checks)
 
 	keep_out_of_scope = malloc(num_checks * sizeof(*keep_out_of_scope));
 	memset(keep_out_of_scope, 0, num_checks * sizeof(*keep_out_of_scope));
+
+	get_state_hooks = malloc(num_checks * sizeof(void *));
+	memset(get_state_hooks, 0, num_checks * sizeof(void *));
 }
 
 bool debug_on(const char *check_name, const char *var)
@@ -326,27 +334,56 @@ void __set_sm_cur_stree(struct sm_state *sm)
 	overwrite_sm_state_stree(&cur_stree, sm);
 }
 
-typedef void (get_state_hook)(int owner, const char *name, struct symbol *sym);
-DECLARE_PTR_LIST(fn_list, get_state_hook *);
-static struct fn_list *get_state_hooks;
-
-void add_get_state_hook(get_state_hook *fn)
+/*
+ * The get_state hooks are called for every get_state() so they are kept in
+ * a table indexed by owner and the dispatcher filters out the common cases
+ * where no hook wants to run.  An owner of -1 means every owner.
+ */
+void add_get_state_hook(int owner, get_state_hook *fn)
 {
-	get_state_hook **p = malloc(sizeof(get_state_hook *));
+	get_state_hook **p;
+	int i;
+
+	if (owner >= num_checks)
+		return;
+
+	if (owner < 0) {
+		for (i = 0; i < num_checks; i++)
+			add_get_state_hook(i, fn);
+		return;
+	}
+
+	p = malloc(sizeof(get_state_hook *));
 	*p = fn;
-	add_ptr_list(&get_state_hooks, p);
+	add_ptr_list(&get_state_hooks[owner], p);
+	has_get_state_hooks = true;
 }
 
 static void call_get_state_hooks(int owner, const char *name, struct symbol *sym)
 {
 	static int recursion;
+	struct get_state_hook_list *hooks;
 	get_state_hook **fn;
 
-	if (recursion)
+	if (!has_get_state_hooks || recursion || !cur_func_sym)
+		return;
+	if (owner < 0 || owner >= num_checks)
+		return;
+	hooks = get_state_hooks[owner];
+	if (!hooks)
 		return;
+
+	/* the fake environments don't read anything real */
+	if (__in_fake_assign ||
+	    __in_fake_parameter_assign ||
+	    __in_fake_struct_assign ||
+	    __in_function_def ||
+	    __in_unmatched_hook)
+		return;
+
 	recursion = 1;
 
-	FOR_EACH_PTR(get_state_hooks, fn) {
+	FOR_EACH_PTR(hooks, fn) {
 		(*fn)(owner, name, sym);
 	} END_FOR_EACH_PTR(fn);
 
@@ -150,19 +150,11 @@ static struct symbol *get_member_symbol(struct symbol_list *symbol_list, struct
 {
 	struct symbol *tmp, *sub;
 
-	FOR_EACH_PTR(symbol_list, tmp) {
-		if (!tmp->ident) {
-			sub = get_real_base_type(tmp);
-			sub = get_member_symbol(sub->symbol_list, member);
-			if (sub)
-				return sub;
-			continue;
-		}
-		if (tmp->ident == member)
-			return tmp;
-	} END_FOR_EACH_PTR(tmp);
-
-	return NULL;
+	tmp = get_struct_member(symbol_list, member);
+	if (!tmp || tmp->ident)
+		return tmp;
+	sub = get_real_base_type(tmp);
+	return get_member_symbol(sub->symbol_list, member);
 }
 
 static struct symbol *get_symbol_from_deref(struct expression *expr)
@@ -253,6 +253,8 @@ void sort_list(struct ptr_list **plist, int (*cmp)(const void *, const void *))
 				if (block2 == head) {
 					if (block1 == head) {
 						BEEN_THERE('A');
+						head->counted = (*plist)->counted;
+						head->count = (*plist)->count;
 						*plist = head;
 						return;
 					}
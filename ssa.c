@@ -396,6 +396,10 @@ void ssa_convert(struct entrypoint *ep)
 	ssa_rename_insns(ep);
 	ssa_rename_phis(ep);
 
+	FOR_EACH_PTR(ep->bbs, bb) {
+		phi_map_free(&bb->phi_map);
+	} END_FOR_EACH_PTR(bb);
+
 	// remove now dead stores
 	remove_dead_stores(stores);
 }
@@ -57,6 +57,12 @@ void show_allocation_stats(void)
 
 void report_stats(void)
 {
-	if (fmem_report)
+	if (fmem_report) {
 		show_allocation_stats();
+		show_identifier_stats();
+	}
+	if (verbose)
+		show_token_cache_stats();
+	if (verbose > 1)
+		show_preprocess_stats();
 }
@@ -674,6 +674,163 @@ struct symbol *examine_pointer_target(struct symbol *sym)
 	return examine_base_type(sym);
 }
 
+/*
+ * Member lookup in structs and unions.
+ *
+ * Short member lists are simply scanned. Lists spanning more than one
+ * ptr_list node get a hash index, built on first use, which maps every
+ * member ident - those of anonymous structs and unions included - to
+ * the top-level member holding it. Members are only ever appended, so
+ * the index is rebuilt whenever the last node has changed since.
+ */
+#define MEMBER_INDEX_BITS (10)
+#define MEMBER_INDEX_SIZE (1 << MEMBER_INDEX_BITS)
+
+struct member_slot {
+	struct ident *ident;
+	struct symbol *member;
+};
+
+struct member_index {
+	struct member_index *next;
+	struct ptr_list *head;
+	struct ptr_list *last;
+	int last_nr;
+	unsigned int mask;
+	struct member_slot slots[];
+};
+
+static struct member_index *member_indexes[MEMBER_INDEX_SIZE];
+
+static inline unsigned int hash_ptr(const void *ptr)
+{
+	return ((unsigned long)ptr >> 3) * 0x9e370001U;
+}
+
+static struct symbol *anonymous_member_type(struct symbol *sym)
+{
+	struct symbol *ctype = sym->ctype.base_type;
+
+	if (!ctype)
+		return NULL;
+	if (ctype->type != SYM_UNION && ctype->type != SYM_STRUCT)
+		return NULL;
+	return ctype;
+}
+
+static void index_member(struct member_index *index, struct ident *ident, struct symbol *member)
+{
+	unsigned int i = hash_ptr(ident) & index->mask;
+
+	while (index->slots[i].ident) {
+		if (index->slots[i].ident == ident)
+			return;		// the first one wins
+		i = (i + 1) & index->mask;
+	}
+	index->slots[i].ident = ident;
+	index->slots[i].member = member;
+}
+
+static int index_members(struct member_index *index, struct symbol_list *list, struct symbol *top)
+{
+	struct symbol *sym, *ctype;
+	int nr = 0;
+
+	FOR_EACH_PTR(list, sym) {
+		struct symbol *member = top ? top : sym;
+
+		if (sym->ident) {
+			if (index)
+				index_member(index, sym->ident, member);
+			nr++;
+		} else if ((ctype = anonymous_member_type(sym))) {
+			nr += index_members(index, ctype->symbol_list, member);
+		}
+	} END_FOR_EACH_PTR(sym);
+	return nr;
+}
+
+static struct member_index *build_member_index(struct symbol_list *list, struct member_index *index)
+{
+	struct ptr_list *head = (struct ptr_list *)list;
+	unsigned int size = 16;
+	int nr;
+
+	nr = index_members(NULL, list, NULL);
+	while (size < 2 * nr)
+		size *= 2;
+	if (!index || index->mask < size - 1) {
+		free(index);
+		index = malloc(sizeof(*index) + size * sizeof(index->slots[0]));
+		if (!index)
+			die("out of memory");
+	} else {
+		size = index->mask + 1;
+	}
+	memset(index->slots, 0, size * sizeof(index->slots[0]));
+	index->head = head;
+	index->last = head->prev;
+	index->last_nr = head->prev->nr;
+	index->mask = size - 1;
+	index_members(index, list, NULL);
+	return index;
+}
+
+static struct member_index *get_member_index(struct symbol_list *list)
+{
+	struct ptr_list *head = (struct ptr_list *)list;
+	struct member_index **bucket, *index;
+
+	bucket = &member_indexes[hash_ptr(head) >> (32 - MEMBER_INDEX_BITS)];
+	for (index = *bucket; index; index = index->next) {
+		if (index->head != head)
+			continue;
+		if (index->last != head->prev || index->last_nr != head->prev->nr)
+			index = build_member_index(list, index);
+		return index;
+	}
+	index = build_member_index(list, NULL);
+	index->next = *bucket;
+	*bucket = index;
+	return index;
+}
+
+///
+// find the member of a struct or union named by @ident
+// @list: the member list of the struct or union
+// @return: the member itself or, if it belongs to an anonymous
+//	struct or union, the anonymous member holding it; or NULL
+struct symbol *get_struct_member(struct symbol_list *list, struct ident *ident)
+{
+	struct ptr_list *head = (struct ptr_list *)list;
+	struct member_index *index;
+	struct symbol *sym, *ctype;
+	unsigned int i;
+
+	if (!head || !ident)
+		return NULL;
+
+	if (head->next == head) {
+		FOR_EACH_PTR(list, sym) {
+			if (sym->ident) {
+				if (sym->ident == ident)
+					return sym;
+			} else if ((ctype = anonymous_member_type(sym))) {
+				if (get_struct_member(ctype->symbol_list, ident))
+					return sym;
+			}
+		} END_FOR_EACH_PTR(sym);
+		return NULL;
+	}
+
+	index = get_member_index(list);
+	for (i = hash_ptr(ident) & index->mask; index->slots[i].ident; i = (i + 1) & index->mask) {
+		if (index->slots[i].ident == ident)
+			return index->slots[i].member;
+	}
+	return NULL;
+}
+
 static struct symbol_list *restr, *fouled;
 
 void create_fouled(struct symbol *type)
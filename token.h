@@ -231,14 +231,20 @@ extern const char *show_token(const struct token *);
 extern const char *quote_token(const struct token *);
 extern struct token * tokenize(const struct position *pos, const char *, int, struct token *, const char **next_path);
 extern struct token * tokenize_buffer(void *, unsigned long, struct token **);
+extern void show_token_cache_stats(void);
 
 extern void show_identifier_stats(void);
 extern void init_include_path(void);
+extern void show_preprocess_stats(void);
 extern struct token *preprocess(struct token *);
 
 extern void store_all_tokens(struct token *token);
+extern struct token *preprocessed_tokens;
 extern struct token *pos_get_token(struct position pos);
 extern char *pos_ident(struct position pos);
+extern struct token *preprocessed_token_at(struct position pos);
+extern struct token *function_end_token(struct token *token);
+extern struct token *function_start_token(struct position pos, struct ident *name);
 
 extern void store_macro_pos(struct token *);
 extern char *get_macro_name(struct position pos);
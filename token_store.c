@@ -175,3 +175,116 @@ char *pos_ident(struct position pos)
 	return token->ident->name;
 }
 
+static int same_pos(struct position a, struct position b)
+{
+	return a.stream == b.stream && a.line == b.line && a.pos == b.pos;
+}
+
+/*
+ * This looks in the stream after preprocessing so macros are expanded.
+ * Normally the callers go through the file in order so we start where the
+ * last search left off.
+ */
+struct token *preprocessed_token_at(struct position pos)
+{
+	static struct token *stream_start;
+	static struct token *pp_cursor;
+	struct token *token;
+
+	if (stream_start != preprocessed_tokens) {
+		stream_start = preprocessed_tokens;
+		pp_cursor = stream_start;
+	}
+	if (!pp_cursor)
+		return NULL;
+
+	for (token = pp_cursor; !eof_token(token); token = token->next) {
+		if (same_pos(token->pos, pos))
+			goto found;
+	}
+	for (token = stream_start; token != pp_cursor; token = token->next) {
+		if (same_pos(token->pos, pos))
+			goto found;
+	}
+	return NULL;
+found:
+	pp_cursor = token;
+	return token;
+}
+
+/*
+ * Checks if the declaration starting at @token is the definition of a
+ * function called @name.
+ */
+static int defines_function(struct token *token, struct ident *name)
+{
+	int depth = 0;
+	int found = 0;
+
+	for (; !eof_token(token); token = token->next) {
+		if (match_op(token, '(')) {
+			depth++;
+		} else if (match_op(token, ')')) {
+			depth--;
+		} else if (depth == 0) {
+			if (match_op(token, '{'))
+				return found;
+			if (match_op(token, ';') || match_op(token, '='))
+				return 0;
+			if (token_type(token) == TOKEN_IDENT &&
+			    token->ident == name && match_op(token->next, '('))
+				found = 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Returns the first token of the definition of the function @name which
+ * is declared at @pos, or NULL if it can't be found without ambiguity.
+ * All the functions generated by the same macro share its position, so
+ * the declarations in the whole run of tokens at @pos are looked at.
+ */
+struct token *function_start_token(struct position pos, struct ident *name)
+{
+	struct token *token, *prev = NULL;
+	struct token *start = NULL;
+	int depth = 0;
+
+	if (!name)
+		return NULL;
+	token = preprocessed_token_at(pos);
+	for (; token && same_pos(token->pos, pos); prev = token, token = token->next) {
+		if (depth == 0 &&
+		    (!prev || match_op(prev, ';') || match_op(prev, '}')) &&
+		    defines_function(token, name)) {
+			if (start)
+				return NULL;
+			start = token;
+		}
+		if (match_op(token, '{'))
+			depth++;
+		else if (match_op(token, '}'))
+			depth--;
+	}
+	return start;
+}
+
+/*
+ * Takes the first token of a function definition and returns the '}' at the
+ * end of the body.
+ */
+struct token *function_end_token(struct token *token)
+{
+	int depth = 0;
+
+	for (; !eof_token(token); token = token->next) {
+		if (match_op(token, '{')) {
+			depth++;
+		} else if (match_op(token, '}')) {
+			if (--depth == 0)
+				return token;
+		}
+	}
+	return NULL;
+}
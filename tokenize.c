@@ -31,6 +31,10 @@
 #include <ctype.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "lib.h"
 #include "allocate.h"
@@ -462,6 +466,44 @@ static inline int nextchar(stream_t *stream)
 	return nextchar_slow(stream);
 }
 
+/*
+ * Skip over characters which can't be interesting directly in the buffer,
+ * without going through nextchar() for each one.  Anything in the stop
+ * table, including tabs, CRs, newlines and backslashes which affect the
+ * position or splice lines, is left for nextchar().
+ */
+static void skip_plain_chars(stream_t *stream, const char *stop)
+{
+	const unsigned char *start = stream->buffer + stream->offset;
+	const unsigned char *end = stream->buffer + stream->size;
+	const unsigned char *p = start;
+
+	while (p < end && !stop[*p])
+		p++;
+	stream->pos += p - start;
+	stream->offset += p - start;
+}
+
+static const char comment_stop[256] = {
+	['*'] = 1, ['\t'] = 1, ['\r'] = 1, ['\n'] = 1, ['\\'] = 1
+};
+
+static const char eoln_stop[256] = {
+	['\t'] = 1, ['\r'] = 1, ['\n'] = 1, ['\\'] = 1
+};
+
+static void skip_spaces(stream_t *stream)
+{
+	const unsigned char *start = stream->buffer + stream->offset;
+	const unsigned char *end = stream->buffer + stream->size;
+	const unsigned char *p = start;
+
+	while (p < end && *p == ' ')
+		p++;
+	stream->pos += p - start;
+	stream->offset += p - start;
+}
+
 struct token eof_token_entry;
 
 static struct token *mark_eof(stream_t *stream)
@@ -655,6 +697,7 @@ static int drop_stream_eoln(stream_t *stream)
 {
 	drop_token(stream);
 	for (;;) {
+		skip_plain_chars(stream, eoln_stop);
 		switch (nextchar(stream)) {
 		case EOF:
 			return EOF;
@@ -678,6 +721,9 @@ static int drop_stream_comment(stream_t *stream)
 			warning(stream_pos(stream), "End of file in the middle of a comment");
 			return curr;
 		}
+		/* if curr isn't a '*' then nothing up to the next '*' can end it */
+		if (curr != '*')
+			skip_plain_chars(stream, comment_stop);
 		next = nextchar(stream);
 		if (curr == '*' && next == '/')
 			break;
@@ -799,29 +845,64 @@ static int get_one_special(int c, stream_t *stream)
 	return next;
 }
 
+/*
+ * The identifier hash table starts with 1 << IDENT_HASH_BITS buckets and
+ * doubles whenever there are more than IDENT_HASH_LOAD identifiers per
+ * bucket.  The idents themselves never move, only the chains are rebuilt
+ * (which means hashing all the names again, but that is rare enough).
+ *
+ * The hash is FNV-1a over the characters followed by the murmur3
+ * finalizer, so that the low bits used for the bucket index depend on
+ * all of the name.
+ */
 #define IDENT_HASH_BITS (13)
-#define IDENT_HASH_SIZE (1<<IDENT_HASH_BITS)
-#define IDENT_HASH_MASK (IDENT_HASH_SIZE-1)
+#define IDENT_HASH_LOAD (2)
 
-#define ident_hash_init(c)		(c)
-#define ident_hash_add(oldhash,c)	((oldhash)*11 + (c))
-#define ident_hash_end(hash)		((((hash) >> IDENT_HASH_BITS) + (hash)) & IDENT_HASH_MASK)
+#define ident_hash_init(c)		ident_hash_add(0x811c9dc5U, c)
+#define ident_hash_add(oldhash,c)	((uint32_t)(((oldhash) ^ (unsigned char)(c)) * 0x01000193U))
+#define ident_hash_end(hash)		ident_hash_mix(hash)
 
-static struct ident *hash_table[IDENT_HASH_SIZE];
-static int ident_hit, ident_miss, idents;
+static inline uint32_t ident_hash_mix(uint32_t hash)
+{
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bU;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35U;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+static uint32_t hash_name(const char *name, int len)
+{
+	uint32_t hash;
+	const unsigned char *p = (const unsigned char *)name;
+
+	hash = ident_hash_init(*p++);
+	while (--len) {
+		unsigned int i = *p++;
+		hash = ident_hash_add(hash, i);
+	}
+	return ident_hash_end(hash);
+}
+
+static struct ident **hash_table;
+static unsigned int ident_hash_size, ident_hash_resizes;
+static int ident_hit, ident_miss, idents, hashed_idents;
 
 void show_identifier_stats(void)
 {
-	int i;
+	unsigned int i;
 	int distribution[100];
 
 	fprintf(stderr, "identifiers: %d hits, %d misses\n",
 		ident_hit, ident_miss);
+	fprintf(stderr, "identifiers: %d in %u buckets, %u resizes\n",
+		hashed_idents, ident_hash_size, ident_hash_resizes);
 
 	for (i = 0; i < 100; i++)
 		distribution[i] = 0;
 
-	for (i = 0; i < IDENT_HASH_SIZE; i++) {
+	for (i = 0; i < ident_hash_size; i++) {
 		struct ident * ident = hash_table[i];
 		int count = 0;
 
@@ -840,6 +921,44 @@ void show_identifier_stats(void)
 	}
 }
 
+static void resize_ident_hash(unsigned int size)
+{
+	struct ident **table;
+	unsigned int i;
+
+	table = calloc(size, sizeof(*table));
+	if (!table)
+		die("out of memory for the identifier hash");
+
+	for (i = 0; i < ident_hash_size; i++) {
+		struct ident *ident, *next;
+
+		for (ident = hash_table[i]; ident; ident = next) {
+			/* get_one_identifier() allows 256 characters */
+			int len = ident->len ? ident->len : 256;
+			struct ident **p = &table[hash_name(ident->name, len) & (size - 1)];
+
+			next = ident->next;
+			ident->next = *p;
+			*p = ident;
+		}
+	}
+	if (hash_table)
+		ident_hash_resizes++;
+	free(hash_table);
+	hash_table = table;
+	ident_hash_size = size;
+}
+
+static struct ident **ident_bucket(uint32_t hash)
+{
+	if (!hash_table)
+		resize_ident_hash(1 << IDENT_HASH_BITS);
+	else if (hashed_idents > ident_hash_size * IDENT_HASH_LOAD)
+		resize_ident_hash(ident_hash_size * 2);
+	return &hash_table[hash & (ident_hash_size - 1)];
+}
+
 struct ident *alloc_ident(const char *name, int len)
 {
 	struct ident *ident = __alloc_ident(len);
@@ -850,20 +969,23 @@ struct ident *alloc_ident(const char *name, int len)
 	return ident;
 }
 
-static struct ident * insert_hash(struct ident *ident, unsigned long hash)
+static struct ident * insert_hash(struct ident *ident, uint32_t hash)
 {
-	ident->next = hash_table[hash];
-	hash_table[hash] = ident;
+	struct ident **p = ident_bucket(hash);
+
+	ident->next = *p;
+	*p = ident;
 	ident_miss++;
+	hashed_idents++;
 	return ident;
 }
 
-static struct ident *create_hashed_ident(const char *name, int len, unsigned long hash)
+static struct ident *create_hashed_ident(const char *name, int len, uint32_t hash)
 {
 	struct ident *ident;
 	struct ident **p;
 
-	p = &hash_table[hash];
+	p = ident_bucket(hash);
 	while ((ident = *p) != NULL) {
 		if (ident->len == (unsigned char) len) {
 			if (strncmp(name, ident->name, len) != 0)
@@ -881,22 +1003,10 @@ next:
 	ident->next = NULL;
 	ident_miss++;
 	idents++;
+	hashed_idents++;
 	return ident;
 }
 
-static unsigned long hash_name(const char *name, int len)
-{
-	unsigned long hash;
-	const unsigned char *p = (const unsigned char *)name;
-
-	hash = ident_hash_init(*p++);
-	while (--len) {
-		unsigned int i = *p++;
-		hash = ident_hash_add(hash, i);
-	}
-	return ident_hash_end(hash);
-}
-
 struct ident *hash_ident(struct ident *ident)
 {
 	return insert_hash(ident, hash_name(ident->name, ident->len));
@@ -923,7 +1033,7 @@ static int get_one_identifier(int c, stream_t *stream)
 {
 	struct token *token;
 	struct ident *ident;
-	unsigned long hash;
+	uint32_t hash;
 	char buf[256];
 	int len = 1;
 	int next;
@@ -1007,6 +1117,7 @@ static struct token *tokenize_stream(stream_t *stream)
 			continue;
 		}
 		stream->whitespace = 1;
+		skip_spaces(stream);
 		c = nextchar(stream);
 	}
 	return mark_eof(stream);
@@ -1022,11 +1133,369 @@ struct token * tokenize_buffer(void *buffer, unsigned long size, struct token **
 	return begin;
 }
 
+/*
+ * Regular files are mapped and tokenized straight from the mapping, the
+ * same way as tokenize_buffer().  Anything else (pipes, stdin, or if the
+ * mmap() fails) is read() in BUFSIZE chunks.
+ */
+static void *map_stream(int fd, const struct stat *st, unsigned int *size)
+{
+	void *map;
+
+	if (!S_ISREG(st->st_mode))
+		return NULL;
+	if (st->st_size <= 0 || st->st_size >= INT_MAX)
+		return NULL;
+	map = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED)
+		return NULL;
+	*size = st->st_size;
+	return map;
+}
+
+/*
+ * With -ftoken-cache=<dir> the raw token stream of each included file is
+ * saved in <dir> once it has been lexed, and later runs load it back
+ * instead of lexing the file again.  The tokens are the ones coming out
+ * of tokenize_stream(), before any preprocessing, so the preprocessor
+ * can't tell the difference.
+ *
+ * A cache file is keyed on the path, size and mtime of the source file,
+ * on the sparse version and on the options which change what the lexer
+ * produces (-ftabstop and -Wnewline-eof), all of which are checked on
+ * load.  Files which produced a diagnostic while being lexed are never
+ * saved, since loading them would lose the diagnostic.
+ *
+ * The file is a header, the path and version strings, an array of
+ * fixed size token records and finally the data the records point into:
+ * identifier names, numbers and strings, each prefixed by its length.
+ */
+#define TOKEN_CACHE_MAGIC	"stc2"
+
+struct token_cache_header {
+	char magic[4];
+	uint32_t name_len;
+	uint32_t version_len;
+	uint32_t nr_tokens;
+	uint32_t data_len;
+	uint32_t mtime_nsec;
+	uint32_t tabstop;
+	uint32_t newline_eof;
+	int64_t mtime;
+	int64_t size;
+};
+
+struct cached_token {
+	uint32_t line;
+	uint16_t pos;
+	uint8_t type;
+	uint8_t flags;
+	uint32_t value;
+};
+
+#define CACHED_NEWLINE		1
+#define CACHED_WHITESPACE	2
+
+static unsigned int token_cache_hits, token_cache_misses, token_cache_saved;
+
+struct cache_buf {
+	char *data;
+	size_t len, alloc;
+};
+
+static void cache_buf_add(struct cache_buf *buf, const void *data, size_t len)
+{
+	if (buf->len + len > buf->alloc) {
+		buf->alloc = (buf->len + len) * 2 + 4096;
+		buf->data = realloc(buf->data, buf->alloc);
+		if (!buf->data)
+			die("out of memory for the token cache");
+	}
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
+}
+
+static uint32_t cache_buf_add_data(struct cache_buf *buf, const void *data, uint32_t len)
+{
+	uint32_t offset = buf->len;
+
+	cache_buf_add(buf, &len, sizeof(len));
+	cache_buf_add(buf, data, len);
+	return offset;
+}
+
+static char *token_cache_path(const char *name)
+{
+	static char path[PATH_MAX];
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	const unsigned char *p;
+
+	for (p = (const unsigned char *)name; *p; p++)
+		hash = (hash ^ *p) * 0x100000001b3ULL;
+	if (snprintf(path, sizeof(path), "%s/%016llx.tok", ftoken_cache,
+		     (unsigned long long)hash) >= sizeof(path))
+		return NULL;
+	return path;
+}
+
+static void fill_cache_header(struct token_cache_header *hdr, const char *name, const struct stat *st)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	memcpy(hdr->magic, TOKEN_CACHE_MAGIC, sizeof(hdr->magic));
+	hdr->name_len = strlen(name);
+	hdr->version_len = strlen(sparse_version);
+	hdr->mtime = st->st_mtim.tv_sec;
+	hdr->mtime_nsec = st->st_mtim.tv_nsec;
+	hdr->size = st->st_size;
+	hdr->tabstop = tabstop;
+	hdr->newline_eof = Wnewline_eof;
+}
+
+static void save_token_cache(const char *name, const struct stat *st, struct token *begin)
+{
+	struct cache_buf records = { }, data = { };
+	struct token_cache_header hdr;
+	struct token *token;
+	char tmp[PATH_MAX];
+	char *path;
+	FILE *f;
+	int ok;
+
+	path = token_cache_path(name);
+	if (!path)
+		return;
+
+	fill_cache_header(&hdr, name, st);
+	for (token = begin; ; token = token->next) {
+		struct cached_token rec = {
+			.line = token->pos.line,
+			.pos = token->pos.pos,
+			.type = token_type(token),
+		};
+		const char *str;
+
+		if (token->pos.newline)
+			rec.flags |= CACHED_NEWLINE;
+		if (token->pos.whitespace)
+			rec.flags |= CACHED_WHITESPACE;
+
+		switch (token_type(token)) {
+		case TOKEN_STREAMBEGIN:
+		case TOKEN_STREAMEND:
+			break;
+		case TOKEN_IDENT:
+			rec.value = cache_buf_add_data(&data, token->ident->name, token->ident->len);
+			break;
+		case TOKEN_NUMBER:
+			str = token->number;
+			rec.value = cache_buf_add_data(&data, str, strlen(str) + 1);
+			break;
+		case TOKEN_CHAR_EMBEDDED_0 ... TOKEN_CHAR_EMBEDDED_3:
+		case TOKEN_WIDE_CHAR_EMBEDDED_0 ... TOKEN_WIDE_CHAR_EMBEDDED_3:
+			memcpy(&rec.value, token->embedded, sizeof(rec.value));
+			break;
+		case TOKEN_CHAR:
+		case TOKEN_WIDE_CHAR:
+		case TOKEN_STRING:
+		case TOKEN_WIDE_STRING:
+			rec.value = cache_buf_add_data(&data, token->string->data, token->string->length);
+			break;
+		case TOKEN_SPECIAL:
+			rec.value = token->special;
+			break;
+		default:
+			goto out;
+		}
+		cache_buf_add(&records, &rec, sizeof(rec));
+		hdr.nr_tokens++;
+		if (token_type(token) == TOKEN_STREAMEND)
+			break;
+	}
+	hdr.data_len = data.len;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid()) >= sizeof(tmp))
+		goto out;
+	f = fopen(tmp, "w");
+	if (!f)
+		goto out;
+	ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+	     fwrite(name, hdr.name_len, 1, f) == 1 &&
+	     fwrite(sparse_version, hdr.version_len, 1, f) == 1 &&
+	     fwrite(records.data, records.len, 1, f) == 1 &&
+	     (!data.len || fwrite(data.data, data.len, 1, f) == 1);
+	if (fclose(f) != 0)
+		ok = 0;
+	if (ok && rename(tmp, path) == 0)
+		token_cache_saved++;
+	else
+		unlink(tmp);
+out:
+	free(records.data);
+	free(data.data);
+}
+
+static const char *cached_data(const char *data, uint32_t data_len, uint32_t offset, uint32_t *len)
+{
+	if (offset > data_len || data_len - offset < sizeof(*len))
+		return NULL;
+	memcpy(len, data + offset, sizeof(*len));
+	offset += sizeof(*len);
+	if (*len > data_len - offset)
+		return NULL;
+	return data + offset;
+}
+
+static struct token *parse_token_cache(const char *map, size_t map_size, int idx,
+	const char *name, const struct stat *st, struct token **endp)
+{
+	struct token_cache_header hdr, want;
+	struct token *begin = NULL, **list = &begin, *token = NULL;
+	const char *records, *data;
+	size_t offset;
+	uint32_t i;
+
+	if (map_size < sizeof(hdr))
+		return NULL;
+	memcpy(&hdr, map, sizeof(hdr));
+	fill_cache_header(&want, name, st);
+	if (memcmp(hdr.magic, want.magic, sizeof(hdr.magic)) != 0 ||
+	    hdr.name_len != want.name_len || hdr.version_len != want.version_len ||
+	    hdr.mtime != want.mtime || hdr.mtime_nsec != want.mtime_nsec ||
+	    hdr.size != want.size || hdr.tabstop != want.tabstop ||
+	    hdr.newline_eof != want.newline_eof || hdr.nr_tokens < 2)
+		return NULL;
+
+	offset = sizeof(hdr);
+	if (map_size - offset < (size_t)hdr.name_len + hdr.version_len)
+		return NULL;
+	if (memcmp(map + offset, name, hdr.name_len) != 0)
+		return NULL;
+	offset += hdr.name_len;
+	if (memcmp(map + offset, sparse_version, hdr.version_len) != 0)
+		return NULL;
+	offset += hdr.version_len;
+	records = map + offset;
+	if ((map_size - offset) / sizeof(struct cached_token) < hdr.nr_tokens)
+		return NULL;
+	offset += (size_t)hdr.nr_tokens * sizeof(struct cached_token);
+	if (map_size - offset != hdr.data_len)
+		return NULL;
+	data = map + offset;
+
+	for (i = 0; i < hdr.nr_tokens; i++) {
+		struct cached_token rec;
+		const char *str;
+		struct string *string;
+		uint32_t len;
+
+		memcpy(&rec, records + i * sizeof(rec), sizeof(rec));
+		if ((i == 0) != (rec.type == TOKEN_STREAMBEGIN) ||
+		    (i == hdr.nr_tokens - 1) != (rec.type == TOKEN_STREAMEND))
+			return NULL;
+
+		token = __alloc_token(0);
+		token->pos.stream = idx;
+		token->pos.line = rec.line;
+		token->pos.pos = rec.pos;
+		token->pos.newline = !!(rec.flags & CACHED_NEWLINE);
+		token->pos.whitespace = !!(rec.flags & CACHED_WHITESPACE);
+		token_type(token) = rec.type;
+
+		switch (rec.type) {
+		case TOKEN_STREAMBEGIN:
+		case TOKEN_STREAMEND:
+			break;
+		case TOKEN_IDENT:
+			str = cached_data(data, hdr.data_len, rec.value, &len);
+			if (!str || !len || len > 255)
+				return NULL;
+			token->ident = create_hashed_ident(str, len, hash_name(str, len));
+			break;
+		case TOKEN_NUMBER:
+			str = cached_data(data, hdr.data_len, rec.value, &len);
+			if (!str || !len || str[len - 1])
+				return NULL;
+			token->number = xmemdup(str, len);
+			break;
+		case TOKEN_CHAR_EMBEDDED_0 ... TOKEN_CHAR_EMBEDDED_3:
+		case TOKEN_WIDE_CHAR_EMBEDDED_0 ... TOKEN_WIDE_CHAR_EMBEDDED_3:
+			memcpy(token->embedded, &rec.value, sizeof(rec.value));
+			break;
+		case TOKEN_CHAR:
+		case TOKEN_WIDE_CHAR:
+		case TOKEN_STRING:
+		case TOKEN_WIDE_STRING:
+			str = cached_data(data, hdr.data_len, rec.value, &len);
+			if (!str || !len || len > MAX_STRING + 1)
+				return NULL;
+			string = __alloc_string(len);
+			memcpy(string->data, str, len);
+			string->length = len;
+			token->string = string;
+			break;
+		case TOKEN_SPECIAL:
+			token->special = rec.value;
+			break;
+		default:
+			return NULL;
+		}
+		*list = token;
+		list = &token->next;
+	}
+
+	/* Same as mark_eof() */
+	eof_token_entry.pos = token->pos;
+	eof_token_entry.pos.type = TOKEN_EOF;
+	eof_token_entry.pos.newline = 1;
+	eof_token_entry.next = &eof_token_entry;
+	token->next = &eof_token_entry;
+	*endp = token;
+	return begin;
+}
+
+static struct token *load_token_cache(int idx, const char *name, const struct stat *st,
+	struct token **endp)
+{
+	struct token *begin = NULL;
+	struct stat cst;
+	char *path;
+	void *map;
+	int fd;
+
+	path = token_cache_path(name);
+	if (!path)
+		return NULL;
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &cst) == 0 && cst.st_size > 0) {
+		map = mmap(NULL, cst.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			begin = parse_token_cache(map, cst.st_size, idx, name, st, endp);
+			munmap(map, cst.st_size);
+		}
+	}
+	close(fd);
+	return begin;
+}
+
+void show_token_cache_stats(void)
+{
+	if (!ftoken_cache)
+		return;
+	fprintf(stderr, "token cache: %u hits, %u misses, %u saved\n",
+		token_cache_hits, token_cache_misses, token_cache_saved);
+}
+
 struct token * tokenize(const struct position *pos, const char *name, int fd, struct token *endtoken, const char **next_path)
 {
 	struct token *begin, *end;
 	stream_t stream;
 	unsigned char buffer[BUFSIZE];
+	unsigned int size, diagnostics;
+	struct stat st;
+	void *map = NULL;
+	int use_cache;
 	int idx;
 
 	idx = init_stream(pos, name, fd, next_path);
@@ -1035,8 +1504,30 @@ struct token * tokenize(const struct position *pos, const char *name, int fd, st
 		return endtoken;
 	}
 
-	begin = setup_stream(&stream, idx, fd, buffer, 0);
+	if (fstat(fd, &st) == 0)
+		map = map_stream(fd, &st, &size);
+	use_cache = ftoken_cache && pos && map;
+	if (use_cache) {
+		begin = load_token_cache(idx, name, &st, &end);
+		if (begin) {
+			token_cache_hits++;
+			munmap(map, size);
+			goto done;
+		}
+		token_cache_misses++;
+	}
+
+	diagnostics = nr_diagnostics;
+	if (map)
+		begin = setup_stream(&stream, idx, -1, map, size);
+	else
+		begin = setup_stream(&stream, idx, fd, buffer, 0);
 	end = tokenize_stream(&stream);
+	if (map)
+		munmap(map, size);
+	if (use_cache && nr_diagnostics == diagnostics)
+		save_token_cache(name, &st, begin);
+done:
 	if (endtoken)
 		end->next = endtoken;
 	return begin;
@@ -0,0 +1,32 @@
+#define X8(M, p)	M(p##0) M(p##1) M(p##2) M(p##3) M(p##4) M(p##5) M(p##6) M(p##7)
+#define X64(M, p)	X8(M, p##0) X8(M, p##1) X8(M, p##2) X8(M, p##3) \
+			X8(M, p##4) X8(M, p##5) X8(M, p##6) X8(M, p##7)
+#define X512(M, p)	X64(M, p##0) X64(M, p##1) X64(M, p##2) X64(M, p##3) \
+			X64(M, p##4) X64(M, p##5) X64(M, p##6) X64(M, p##7)
+#define X4096(M, p)	X512(M, p##0) X512(M, p##1) X512(M, p##2) X512(M, p##3) \
+			X512(M, p##4) X512(M, p##5) X512(M, p##6) X512(M, p##7)
+
+#define DECL(v)	int v = a;
+#define SET(v)	v = b;
+#define SUM(v)	v +
+
+int foo(int a, int b)
+{
+	X4096(DECL, v)
+	if (b) {
+		X4096(SET, v)
+	}
+	return X4096(SUM, v) 0;
+}
+
+/*
+ * check-name: many-locals
+ * check-description: the SSA conversion must cope with functions
+ *	having thousands of local variables.
+ * check-command: test-linearize -Wno-decl $file
+ * check-output-ignore
+ *
+ * check-output-excludes: load\\.
+ * check-output-excludes: store\\.
+ * check-output-contains: select\\.
+ */
@@ -0,0 +1,28 @@
+#include "check_debug.h"
+
+int frob(void);
+
+static inline int add_one(int x)
+{
+	__smatch_implied(x);
+	return x + 1;
+}
+
+int test(void)
+{
+	int x = frob();
+
+	if (x < 0 || x > 10)
+		return 0;
+	return add_one(x);
+}
+
+/*
+ * check-name: smatch function cache #1
+ * check-command: validation/smatch_function_cache_test.sh -I.. sm_function_cache1.c
+ *
+ * check-output-start
+sm_function_cache1.c:7 add_one() implied: x = ''
+sm_function_cache1.c:11 (null)() function cache: hits: 3 misses: 0 verified: 0 mismatches: 0
+ * check-output-end
+ */
@@ -0,0 +1,30 @@
+#include "check_debug.h"
+
+int frob(void);
+
+int test(void)
+{
+	int i = 0;
+	int ret;
+
+	frob();
+retry:
+	__smatch_implied(i);
+	ret = frob();
+	if (ret && i < 4) {
+		i++;
+		goto retry;
+	}
+	__smatch_implied(i);
+
+	return ret;
+}
+/*
+ * check-name: smatch goto worklist #2
+ * check-command: smatch -I.. sm_goto_worklist2.c
+ *
+ * check-output-start
+sm_goto_worklist2.c:12 test() implied: i = '0'
+sm_goto_worklist2.c:18 test() implied: i = '0'
+ * check-output-end
+ */
@@ -0,0 +1,39 @@
+#include "check_debug.h"
+
+int frob(void);
+
+void test(void)
+{
+	int i, j = 0, k = 0, x = 0;
+
+	for (i = 0; i < 10; i++) {
+		__smatch_implied(i);
+		__smatch_implied(j);
+		j = i;
+	}
+	__smatch_implied(j);
+
+	while (frob()) {
+		__smatch_implied(x);
+		x = 5;
+	}
+
+	while (k < 100) {
+		__smatch_implied(k);
+		if (frob())
+			break;
+		k += 2;
+	}
+}
+/*
+ * check-name: smatch loop fixpoint #3
+ * check-command: smatch --loop-fixpoint -I.. sm_loop_fixpoint3.c
+ *
+ * check-output-start
+sm_loop_fixpoint3.c:10 test() implied: i = '0-9'
+sm_loop_fixpoint3.c:11 test() implied: j = '0-9'
+sm_loop_fixpoint3.c:14 test() implied: j = '0-9'
+sm_loop_fixpoint3.c:17 test() implied: x = '0,5'
+sm_loop_fixpoint3.c:22 test() implied: k = '0,2-99'
+ * check-output-end
+ */
@@ -0,0 +1,11 @@
+#!/bin/bash
+
+# Run smatch twice with the same --function-cache directory and print the
+# output of the second run, which should come from the cache.
+
+dir=$(mktemp -d)
+
+../smatch --function-cache=$dir $* > /dev/null 2>&1
+../smatch --function-cache=$dir $*
+
+rm -rf $dir